@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "geotiv/types.hpp" // Compression
+
+// Deflate goes through the system zlib. The CMake target defines GEOTIV_HAS_ZLIB=1 and links ZLIB::ZLIB
+// when zlib is found; other builds can define it themselves and link -lz.
+#ifndef GEOTIV_HAS_ZLIB
+#define GEOTIV_HAS_ZLIB 0
+#endif
+#if GEOTIV_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace geotiv {
+
+    /// Whether this build can read and write blocks with codec c
+    inline bool compressionAvailable(Compression c) {
+        switch (c) {
+        case Compression::None:
+        case Compression::LZW:
+        case Compression::PackBits:
+            return true;
+        case Compression::Deflate:
+            return GEOTIV_HAS_ZLIB;
+        }
+        return false;
+    }
+
+    namespace detail {
+        // ------------------------------------------------------------------
+        // PackBits (32773): byte-oriented run-length encoding
+        // ------------------------------------------------------------------
+        /// Runs of two or more equal bytes become (1 - run, byte); everything else is copied in literal
+        /// packets of up to 128 bytes, which end early where a run of three or more begins.
+        inline std::vector<uint8_t> packBitsEncode(const uint8_t *src, size_t n) {
+            std::vector<uint8_t> out;
+            out.reserve(n + n / 128 + 1);
+            size_t i = 0;
+            while (i < n) {
+                size_t run = 1;
+                while (i + run < n && run < 128 && src[i + run] == src[i])
+                    ++run;
+                if (run >= 2) {
+                    out.push_back(uint8_t(257 - run)); // -(run - 1) as a signed byte
+                    out.push_back(src[i]);
+                    i += run;
+                    continue;
+                }
+                size_t start = i;
+                while (i < n && i - start < 128) {
+                    if (i + 2 < n && src[i] == src[i + 1] && src[i] == src[i + 2])
+                        break;
+                    ++i;
+                }
+                out.push_back(uint8_t(i - start - 1));
+                out.insert(out.end(), src + start, src + i);
+            }
+            return out;
+        }
+
+        /// Decode into exactly outSize bytes; packets past a full output are ignored (some writers pad)
+        inline void packBitsDecode(const uint8_t *src, size_t n, uint8_t *out, size_t outSize) {
+            size_t i = 0, o = 0;
+            while (o < outSize) {
+                if (i >= n)
+                    throw std::runtime_error("PackBits data ends early");
+                int8_t header = int8_t(src[i++]);
+                if (header >= 0) {
+                    size_t len = size_t(header) + 1;
+                    if (i + len > n || o + len > outSize)
+                        throw std::runtime_error("PackBits literal overruns its block");
+                    std::memcpy(out + o, src + i, len);
+                    i += len;
+                    o += len;
+                } else if (header != -128) { // -128 is a no-op
+                    size_t len = size_t(1 - header);
+                    if (i >= n || o + len > outSize)
+                        throw std::runtime_error("PackBits run overruns its block");
+                    std::memset(out + o, src[i++], len);
+                    o += len;
+                }
+            }
+        }
+
+        // ------------------------------------------------------------------
+        // LZW (5): TIFF flavour, MSB-first codes of 9-12 bits with the "early change" width switch
+        // ------------------------------------------------------------------
+        constexpr uint32_t kLZWClear = 256, kLZWEnd = 257, kLZWFirst = 258;
+
+        inline std::vector<uint8_t> lzwEncode(const uint8_t *src, size_t n) {
+            std::vector<uint8_t> out;
+            out.reserve(n / 2 + 16);
+            uint32_t acc = 0;
+            int accBits = 0, bits = 9;
+            auto put = [&](uint32_t code) {
+                acc = (acc << bits) | code;
+                accBits += bits;
+                while (accBits >= 8) {
+                    accBits -= 8;
+                    out.push_back(uint8_t(acc >> accBits));
+                }
+                acc &= (1u << accBits) - 1;
+            };
+
+            // Open-addressed (prefix code, next byte) -> code table, cleared whenever the code space fills up
+            constexpr size_t kSlots = 1 << 13;
+            std::vector<uint32_t> keys(kSlots, ~0u);
+            std::vector<uint16_t> codes(kSlots);
+            uint32_t next = kLZWFirst;
+
+            // Codes widen as soon as entry 511, 1023 or 2047 exists (TIFF's "early change", one entry before
+            // plain LZW), and a full table is reset with a Clear code.
+            auto grow = [&]() {
+                ++next;
+                if (next == 4094) {
+                    put(kLZWClear);
+                    std::fill(keys.begin(), keys.end(), ~0u);
+                    next = kLZWFirst;
+                    bits = 9;
+                } else if (next > (1u << bits) - 1) {
+                    ++bits;
+                }
+            };
+
+            put(kLZWClear);
+            if (n) {
+                uint32_t omega = src[0];
+                for (size_t i = 1; i < n; ++i) {
+                    uint32_t key = (omega << 8) | src[i];
+                    size_t slot = (key * 2654435761u) >> 19;
+                    while (keys[slot] != ~0u && keys[slot] != key)
+                        slot = (slot + 1) & (kSlots - 1);
+                    if (keys[slot] == key) {
+                        omega = codes[slot];
+                        continue;
+                    }
+                    put(omega);
+                    keys[slot] = key;
+                    codes[slot] = uint16_t(next);
+                    grow();
+                    omega = src[i];
+                }
+                put(omega);
+                // The decoder adds one more entry after the last code, which may widen the End code
+                if (next + 1 > (1u << bits) - 1)
+                    ++bits;
+            }
+            put(kLZWEnd);
+            if (accBits)
+                out.push_back(uint8_t(acc << (8 - accBits)));
+            return out;
+        }
+
+        /// Decode into exactly outSize bytes. Strings are written back to front straight into out, so every
+        /// code costs one walk along its prefix chain and no intermediate copies.
+        inline void lzwDecode(const uint8_t *src, size_t n, uint8_t *out, size_t outSize) {
+            struct Entry {
+                uint16_t prefix;
+                uint16_t length;
+                uint8_t suffix, first;
+            };
+            std::vector<Entry> table(4096);
+            for (uint32_t i = 0; i < 256; ++i)
+                table[i] = {0, 1, uint8_t(i), uint8_t(i)};
+
+            uint64_t acc = 0;
+            int accBits = 0, bits = 9;
+            size_t pos = 0;
+            auto get = [&]() -> uint32_t {
+                while (accBits < bits) {
+                    if (pos >= n)
+                        return kLZWEnd; // a missing End code ends the block
+                    acc = (acc << 8) | src[pos++];
+                    accBits += 8;
+                }
+                accBits -= bits;
+                return uint32_t(acc >> accBits) & ((1u << bits) - 1);
+            };
+
+            size_t o = 0;
+            auto emit = [&](uint32_t code) {
+                size_t len = table[code].length;
+                size_t end = o + len;
+                for (size_t k = end; k-- > o; code = table[code].prefix) {
+                    if (k < outSize)
+                        out[k] = table[code].suffix;
+                }
+                o = end;
+            };
+
+            uint32_t next = kLZWFirst;
+            uint32_t old = kLZWClear; // no previous code yet
+            while (o < outSize) {
+                uint32_t code = get();
+                if (code == kLZWEnd)
+                    break;
+                if (code == kLZWClear) {
+                    next = kLZWFirst;
+                    bits = 9;
+                    old = kLZWClear;
+                    continue;
+                }
+                if (old == kLZWClear) {
+                    if (code > 255)
+                        throw std::runtime_error("Corrupt LZW data: code " + std::to_string(code) + " after Clear");
+                    emit(code);
+                    old = code;
+                    continue;
+                }
+                if (code > next || code == kLZWClear || code == kLZWEnd)
+                    throw std::runtime_error("Corrupt LZW data: code " + std::to_string(code) + " not in table");
+                if (next < 4096) {
+                    // The new entry is old + first byte of code; when code is that very entry, its first byte is old's
+                    uint8_t first = code == next ? table[old].first : table[code].first;
+                    table[next] = {uint16_t(old), uint16_t(table[old].length + 1), first, table[old].first};
+                    ++next;
+                    if (next >= (1u << bits) - 1 && bits < 12)
+                        ++bits;
+                }
+                emit(code);
+                old = code;
+            }
+            if (o < outSize)
+                throw std::runtime_error("LZW data ends early: " + std::to_string(o) + " of " +
+                                         std::to_string(outSize) + " bytes");
+        }
+
+        // ------------------------------------------------------------------
+        // Deflate (8): zlib stream through the system zlib
+        // ------------------------------------------------------------------
+        inline std::vector<uint8_t> deflateEncode(const uint8_t *src, size_t n) {
+#if GEOTIV_HAS_ZLIB
+            uLongf size = compressBound(uLong(n));
+            std::vector<uint8_t> out(size);
+            if (compress2(out.data(), &size, src, uLong(n), Z_DEFAULT_COMPRESSION) != Z_OK)
+                throw std::runtime_error("Deflate compression failed");
+            out.resize(size);
+            return out;
+#else
+            (void)src;
+            (void)n;
+            throw std::runtime_error("Deflate compression needs zlib (build with GEOTIV_HAS_ZLIB=1)");
+#endif
+        }
+
+        /// Inflate a zlib stream into exactly outSize bytes
+        inline void deflateDecode(const uint8_t *src, size_t n, uint8_t *out, size_t outSize) {
+#if GEOTIV_HAS_ZLIB
+            z_stream zs{};
+            if (inflateInit(&zs) != Z_OK)
+                throw std::runtime_error("Deflate decoder init failed");
+            zs.next_in = const_cast<Bytef *>(src);
+            zs.avail_in = uInt(n);
+            zs.next_out = out;
+            zs.avail_out = uInt(outSize);
+            int rc = inflate(&zs, Z_FINISH);
+            size_t produced = zs.total_out;
+            inflateEnd(&zs);
+            // A full output with trailing input left is accepted, as libtiff does
+            if ((rc != Z_STREAM_END && !(rc == Z_BUF_ERROR && zs.avail_out == 0)) || produced != outSize)
+                throw std::runtime_error("Corrupt Deflate data: got " + std::to_string(produced) + " of " +
+                                         std::to_string(outSize) + " bytes");
+#else
+            (void)src;
+            (void)n;
+            (void)out;
+            (void)outSize;
+            throw std::runtime_error("Deflate decompression needs zlib (build with GEOTIV_HAS_ZLIB=1)");
+#endif
+        }
+
+        /// One strip or tile compressed with codec c; every block is self-contained
+        inline std::vector<uint8_t> encodeBlock(Compression c, const uint8_t *src, size_t n) {
+            switch (c) {
+            case Compression::None:
+                return std::vector<uint8_t>(src, src + n);
+            case Compression::LZW:
+                return lzwEncode(src, n);
+            case Compression::Deflate:
+                return deflateEncode(src, n);
+            case Compression::PackBits:
+                return packBitsEncode(src, n);
+            }
+            throw std::runtime_error("Unsupported compression " + std::to_string(uint16_t(c)));
+        }
+
+        /// Upper bound of encodeBlock's output for n input bytes. PackBits adds a header per 128 bytes, LZW spends
+        /// at most 12 bits per input byte plus Clear and End codes, Deflate stays within zlib's compressBound.
+        inline uint64_t encodeBound(Compression c, uint64_t n) {
+            switch (c) {
+            case Compression::None:
+                return n;
+            case Compression::PackBits:
+                return n + (n + 127) / 128;
+            case Compression::LZW:
+                return n + n / 2 + n / 1024 + 8;
+            case Compression::Deflate:
+                return n + (n >> 12) + (n >> 14) + (n >> 25) + 13;
+            }
+            throw std::runtime_error("Unsupported compression " + std::to_string(uint16_t(c)));
+        }
+
+        /// Decompress one strip or tile into exactly outSize bytes
+        inline void decodeBlock(Compression c, const uint8_t *src, size_t n, uint8_t *out, size_t outSize) {
+            switch (c) {
+            case Compression::None:
+                if (n < outSize)
+                    throw std::runtime_error("Block holds " + std::to_string(n) + " of " + std::to_string(outSize) +
+                                             " bytes");
+                std::memcpy(out, src, outSize);
+                return;
+            case Compression::LZW:
+                return lzwDecode(src, n, out, outSize);
+            case Compression::Deflate:
+                return deflateDecode(src, n, out, outSize);
+            case Compression::PackBits:
+                return packBitsDecode(src, n, out, outSize);
+            }
+            throw std::runtime_error("Unsupported compression " + std::to_string(uint16_t(c)));
+        }
+    } // namespace detail
+} // namespace geotiv
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring> // for std::memcpy
+#include <type_traits>
+
+namespace geotiv {
+    namespace detail {
+        inline constexpr bool kHostLittle = std::endian::native == std::endian::little;
+
+        inline uint16_t byteswap(uint16_t v) { return uint16_t((v >> 8) | (v << 8)); }
+        inline uint32_t byteswap(uint32_t v) {
+            return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+        }
+        inline uint64_t byteswap(uint64_t v) {
+            return (uint64_t(byteswap(uint32_t(v))) << 32) | byteswap(uint32_t(v >> 32));
+        }
+
+        /// Unsigned integer with the same size as a 2, 4 or 8 byte sample type
+        template <size_t N>
+        using UIntOfSize = std::conditional_t<N == 2, uint16_t, std::conditional_t<N == 4, uint32_t, uint64_t>>;
+
+        /// Loads and stores of values kept in a file's byte order, fixed at compile time (Little = "II", else "MM").
+        /// The parser is instantiated once per order and dispatched right after the header, so every
+        /// field or sample decode inlines to a plain load (plus a bswap for the non-native order).
+        /// T may be any 1, 2, 4 or 8 byte integer or floating-point type.
+        template <bool Little> struct Endian {
+            template <typename T> static T load(const uint8_t *p) {
+                T v;
+                if constexpr (sizeof(T) == 1 || Little == kHostLittle) {
+                    std::memcpy(&v, p, sizeof(T));
+                } else {
+                    UIntOfSize<sizeof(T)> w;
+                    std::memcpy(&w, p, sizeof(T));
+                    v = std::bit_cast<T>(byteswap(w));
+                }
+                return v;
+            }
+
+            template <typename T> static void store(uint8_t *p, T v) {
+                if constexpr (sizeof(T) == 1 || Little == kHostLittle) {
+                    std::memcpy(p, &v, sizeof(T));
+                } else {
+                    auto w = byteswap(std::bit_cast<UIntOfSize<sizeof(T)>>(v));
+                    std::memcpy(p, &w, sizeof(T));
+                }
+            }
+
+            /// Unsigned value of n = 2, 4 or 8 bytes, widened to 64 bits
+            static uint64_t uint(const uint8_t *p, size_t n) {
+                return n == 2 ? load<uint16_t>(p) : n == 4 ? load<uint32_t>(p) : load<uint64_t>(p);
+            }
+        };
+    } // namespace detail
+} // namespace geotiv
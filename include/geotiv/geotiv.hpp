@@ -1,5 +1,6 @@
 #pragma once
 
 #include "parser.hpp"
+#include "source.hpp"
 #include "types.hpp"
 #include "writter.hpp"
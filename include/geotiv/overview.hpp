@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "concord/concord.hpp" // Grid, Pose
+#include "geotiv/parallel.hpp"
+#include "geotiv/simd.hpp"
+#include "geotiv/types.hpp" // Resampling
+
+namespace geotiv {
+    namespace detail {
+        // ------------------------------------------------------------------
+        // 2x2 reductions. Odd edges repeat their last row/column, which leaves mean, max and mode of the
+        // remaining pixels unchanged, so every output pixel goes through the same four-value kernel.
+        // ------------------------------------------------------------------
+        /// Reduce the block p q / r s (p, q on the upper row)
+        template <typename T> T reduceBlock(Resampling m, T p, T q, T r, T s) {
+            if (m == Resampling::Mean) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    return ((p + r) + (q + s)) * T(0.25); // column sums first, as the SIMD kernel adds them
+                } else {
+                    int64_t sum = int64_t(p) + int64_t(q) + int64_t(r) + int64_t(s);
+                    return T((sum + 2) >> 2); // round half up
+                }
+            }
+            if (m == Resampling::Max) {
+                auto maxOf = [](T x, T y) { return x > y ? x : y; };
+                return maxOf(maxOf(p, r), maxOf(q, s));
+            }
+            // Mode: most frequent value, ties to the first in p, q, r, s order
+            int cp = 1 + (p == q) + (p == r) + (p == s);
+            int cq = 1 + (q == r) + (q == s) + (q == p);
+            int cr = 1 + (r == s) + (r == p) + (r == q);
+            int cs = 1 + (s == p) + (s == q) + (s == r);
+            T best = p;
+            int count = cp;
+            if (cq > count)
+                best = q, count = cq;
+            if (cr > count)
+                best = r, count = cr;
+            if (cs > count)
+                best = s;
+            return best;
+        }
+
+        /// Reduce columns [2 * c0, 2 * outCols) of rows a (upper) and b (lower) into out[c0, outCols).
+        /// Returns the first column left to the caller (c0 when nothing was vectorized).
+        template <typename T>
+        size_t reducePairsSimd(Resampling m, const T *a, const T *b, T *out, size_t c0, size_t outCols) {
+            size_t c = c0;
+#if GEOTIV_HAS_SSE2
+            if constexpr (std::is_same_v<T, uint8_t>) {
+                // 16 outputs from 32 bytes of each row; pairs are summed or compared in 16-bit lanes
+                const __m128i low = _mm_set1_epi16(0x00FF);
+                auto pairSum = [&](__m128i x) { return _mm_add_epi16(_mm_and_si128(x, low), _mm_srli_epi16(x, 8)); };
+                auto pairMax = [&](__m128i x) { return _mm_max_epi16(_mm_and_si128(x, low), _mm_srli_epi16(x, 8)); };
+                for (; m != Resampling::Mode && c + 16 <= outCols; c += 16) {
+                    __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 2 * c));
+                    __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 2 * c + 16));
+                    __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 2 * c));
+                    __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 2 * c + 16));
+                    __m128i lo, hi;
+                    if (m == Resampling::Mean) {
+                        const __m128i two = _mm_set1_epi16(2);
+                        lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(pairSum(a0), pairSum(b0)), two), 2);
+                        hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(pairSum(a1), pairSum(b1)), two), 2);
+                    } else {
+                        lo = pairMax(_mm_max_epu8(a0, b0));
+                        hi = pairMax(_mm_max_epu8(a1, b1));
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + c), _mm_packus_epi16(lo, hi));
+                }
+            } else if constexpr (std::is_same_v<T, float>) {
+                // 4 outputs from 8 floats of each row: columns first, then even/odd lanes
+                for (; m != Resampling::Mode && c + 4 <= outCols; c += 4) {
+                    __m128 a0 = _mm_loadu_ps(a + 2 * c), a1 = _mm_loadu_ps(a + 2 * c + 4);
+                    __m128 b0 = _mm_loadu_ps(b + 2 * c), b1 = _mm_loadu_ps(b + 2 * c + 4);
+                    __m128 v0 = m == Resampling::Mean ? _mm_add_ps(a0, b0) : _mm_max_ps(a0, b0);
+                    __m128 v1 = m == Resampling::Mean ? _mm_add_ps(a1, b1) : _mm_max_ps(a1, b1);
+                    __m128 even = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+                    __m128 odd = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+                    __m128 v = m == Resampling::Mean ? _mm_mul_ps(_mm_add_ps(even, odd), _mm_set1_ps(0.25f))
+                                                     : _mm_max_ps(even, odd);
+                    _mm_storeu_ps(out + c, v);
+                }
+            }
+#else
+            (void)m, (void)a, (void)b, (void)out, (void)outCols;
+#endif
+            return c;
+        }
+
+        /// One output row from input rows a and b of `cols` samples
+        template <typename T> void reduceRow(Resampling m, const T *a, const T *b, size_t cols, T *out) {
+            size_t pairs = cols / 2;
+            size_t c = reducePairsSimd(m, a, b, out, 0, pairs);
+            for (; c < pairs; ++c)
+                out[c] = reduceBlock(m, a[2 * c], a[2 * c + 1], b[2 * c], b[2 * c + 1]);
+            if (cols % 2)
+                out[pairs] = reduceBlock(m, a[cols - 1], a[cols - 1], b[cols - 1], b[cols - 1]);
+        }
+
+        /// Half-size grid of g (odd sizes round up) with cells of resolution, centered on shift.
+        /// Output rows are split into bands spread over `threads` threads.
+        template <typename T>
+        concord::Grid<T> downsample(concord::Grid<T> const &g, Resampling m, double resolution,
+                                    concord::Pose const &shift, unsigned threads) {
+            size_t rows = g.rows(), cols = g.cols();
+            size_t outRows = (rows + 1) / 2, outCols = (cols + 1) / 2;
+            concord::Grid<T> out(outRows, outCols, resolution, true, shift);
+
+            size_t bands = std::min<size_t>(outRows, size_t(threads) * 4);
+            parallelFor(bands, threads, [&](size_t band) {
+                std::vector<T> a(cols), b(cols), o(outCols);
+                for (size_t r = outRows * band / bands; r < outRows * (band + 1) / bands; ++r) {
+                    size_t r1 = std::min(2 * r + 1, rows - 1);
+                    for (size_t c = 0; c < cols; ++c) {
+                        a[c] = g(2 * r, c);
+                        b[c] = g(r1, c);
+                    }
+                    reduceRow(m, a.data(), b.data(), cols, o.data());
+                    for (size_t c = 0; c < outCols; ++c)
+                        out(r, c) = o[c];
+                }
+            });
+            return out;
+        }
+    } // namespace detail
+} // namespace geotiv
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace geotiv {
+    namespace detail {
+        /// Number of worker threads for a requested count, 0 meaning one per hardware thread.
+        inline unsigned resolveThreads(unsigned requested) {
+            if (requested != 0)
+                return requested;
+            unsigned hw = std::thread::hardware_concurrency();
+            return hw ? hw : 1;
+        }
+
+        /// Run body(i) for every i in [0, n) on up to `threads` threads (the caller's included).
+        /// Indices are handed out one at a time; the first exception thrown by any body is rethrown here.
+        template <typename F> void parallelFor(size_t n, unsigned threads, F &&body) {
+            size_t workers = std::min<size_t>(threads, n);
+            if (workers <= 1) {
+                for (size_t i = 0; i < n; ++i)
+                    body(i);
+                return;
+            }
+
+            std::atomic<size_t> next{0};
+            std::exception_ptr error;
+            std::mutex errorMutex;
+            auto work = [&]() {
+                for (size_t i = next++; i < n; i = next++) {
+                    try {
+                        body(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (!error)
+                            error = std::current_exception();
+                        next = n; // stop handing out work
+                    }
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(workers - 1);
+            for (size_t w = 1; w < workers; ++w)
+                pool.emplace_back(work);
+            work();
+            for (auto &th : pool)
+                th.join();
+            if (error)
+                std::rethrow_exception(error);
+        }
+    } // namespace detail
+} // namespace geotiv
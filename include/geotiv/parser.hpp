@@ -1,95 +1,116 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstring> // for std::memcpy
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "concord/concord.hpp" // for CRS, Datum, Euler
 
+#include "geotiv/codec.hpp"
+#include "geotiv/endian.hpp"
+#include "geotiv/parallel.hpp"
+#include "geotiv/predictor.hpp"
+#include "geotiv/source.hpp"
 #include "geotiv/types.hpp"
 
 namespace geotiv {
     namespace fs = std::filesystem;
 
     // ------------------------------------------------------------------
-    // Low-level TIFF readers (including 64-bit for DOUBLE)
+    // Low-level TIFF decoding (including 64-bit for DOUBLE)
     // ------------------------------------------------------------------
     namespace detail {
-        inline uint16_t readLE16(std::ifstream &f) {
-            uint16_t v = 0;
-            f.read(reinterpret_cast<char *>(&v), sizeof(v));
-            if (f.gcount() != sizeof(v)) {
-                throw std::runtime_error("Failed to read LE16");
-            }
-            return v;
-        }
+        struct TIFFEntry {
+            uint16_t tag, type;
+            uint64_t count, valueOffset;
+            uint8_t raw[8]; // the value/offset field as stored (4 bytes in classic TIFF, 8 in BigTIFF)
+        };
 
-        inline uint32_t readLE32(std::ifstream &f) {
-            uint32_t v = 0;
-            f.read(reinterpret_cast<char *>(&v), sizeof(v));
-            if (f.gcount() != sizeof(v))
-                throw std::runtime_error("Failed to read LE32");
-            return v;
-        }
+        /// The entries of one IFD in a contiguous array sorted by tag. TIFF requires ascending tags on disk,
+        /// so the array is normally used as read; sorting is a fallback for files that break the rule.
+        struct IFDDirectory {
+            std::vector<TIFFEntry> entries;
 
-        inline uint64_t readLE64(std::ifstream &f) {
-            uint64_t v = 0;
-            f.read(reinterpret_cast<char *>(&v), sizeof(v));
-            if (f.gcount() != sizeof(v))
-                throw std::runtime_error("Failed to read LE64");
-            return v;
-        }
+            /// Sort by tag if needed; a repeated tag keeps its last occurrence
+            void finalize() {
+                auto notAscending = [](TIFFEntry const &a, TIFFEntry const &b) { return a.tag >= b.tag; };
+                if (std::adjacent_find(entries.begin(), entries.end(), notAscending) == entries.end())
+                    return;
+                std::stable_sort(entries.begin(), entries.end(),
+                                 [](TIFFEntry const &a, TIFFEntry const &b) { return a.tag < b.tag; });
+                std::vector<TIFFEntry> unique;
+                unique.reserve(entries.size());
+                for (auto const &e : entries) {
+                    if (!unique.empty() && unique.back().tag == e.tag)
+                        unique.back() = e;
+                    else
+                        unique.push_back(e);
+                }
+                entries.swap(unique);
+            }
 
-        inline uint16_t readBE16(std::ifstream &f) {
-            uint8_t bytes[2];
-            f.read(reinterpret_cast<char *>(bytes), 2);
-            if (f.gcount() != 2)
-                throw std::runtime_error("Failed to read BE16");
-            return (uint16_t(bytes[0]) << 8) | uint16_t(bytes[1]);
-        }
+            const TIFFEntry *find(uint16_t tag) const {
+                auto it = std::lower_bound(entries.begin(), entries.end(), tag,
+                                           [](TIFFEntry const &e, uint16_t t) { return e.tag < t; });
+                return (it != entries.end() && it->tag == tag) ? &*it : nullptr;
+            }
+        };
 
-        inline uint32_t readBE32(std::ifstream &f) {
-            uint8_t bytes[4];
-            f.read(reinterpret_cast<char *>(bytes), 4);
-            if (f.gcount() != 4)
-                throw std::runtime_error("Failed to read BE32");
-            return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) |
-                   uint32_t(bytes[3]);
+        // ------------------------------------------------------------------
+        // Bulk decoding of tag arrays
+        // ------------------------------------------------------------------
+        /// Decode n consecutive Word values stored in the Little byte order into out[0..n). Same-width words are
+        /// copied out in one block and swapped in place; narrower ones (LONG offsets into 64-bit arrays) are
+        /// loaded and widened straight into out. Both loops vectorize (pshufb/vpshufb on x86).
+        template <bool Little, typename Word, typename Out> void decodeWords(const uint8_t *src, size_t n, Out *out) {
+            if constexpr (std::is_same_v<Word, Out>) {
+                if (n)
+                    std::memcpy(out, src, n * sizeof(Word));
+                if constexpr (Little != kHostLittle) {
+                    for (size_t i = 0; i < n; ++i)
+                        out[i] = byteswap(out[i]);
+                }
+            } else {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = Out(Endian<Little>::template load<Word>(src + i * sizeof(Word)));
+            }
         }
 
-        inline uint64_t readBE64(std::ifstream &f) {
-            uint8_t bytes[8];
-            f.read(reinterpret_cast<char *>(bytes), 8);
-            if (f.gcount() != 8)
-                throw std::runtime_error("Failed to read BE64");
-            uint64_t result = 0;
-            for (int i = 0; i < 8; ++i) {
-                result = (result << 8) | uint64_t(bytes[i]);
+        /// Size in bytes of one value of a TIFF field type (0 for unknown types)
+        inline size_t typeSize(uint16_t type) {
+            switch (type) {
+            case 1: case 2: case 6: case 7: // BYTE, ASCII, SBYTE, UNDEFINED
+                return 1;
+            case 3: case 8: // SHORT, SSHORT
+                return 2;
+            case 4: case 9: case 11: case 13: // LONG, SLONG, FLOAT, IFD
+                return 4;
+            case 5: case 10: case 12: case 16: case 17: case 18: // RATIONAL, SRATIONAL, DOUBLE, LONG8, SLONG8, IFD8
+                return 8;
             }
-            return result;
+            return 0;
         }
 
-        struct TIFFEntry {
-            uint16_t tag, type;
-            uint32_t count, valueOffset;
-        };
-
         // All CRS are now WGS84 - no parsing needed
 
-        inline std::string readString(std::ifstream &f, uint32_t offset, uint32_t count) {
+        inline std::string readString(Cursor &f, uint64_t offset, uint64_t count) {
             if (count == 0)
                 return "";
             std::vector<char> buf(count);
-            f.seekg(offset, std::ios::beg);
-            f.read(buf.data(), count);
-            if (f.gcount() != static_cast<std::streamsize>(count))
+            f.seek(offset);
+            if (f.read(buf.data(), count) != count)
                 throw std::runtime_error("Failed to read string data");
 
             // Ensure null termination
@@ -98,127 +119,189 @@ namespace geotiv {
             }
             return std::string(buf.data());
         }
-    } // namespace detail
+        // ------------------------------------------------------------------
+        // Byte order + the open source, shared by every IFD of a file
+        // ------------------------------------------------------------------
+        struct TIFFFile {
+            Cursor &f;
+            bool little = true;   // "II"; the parser is dispatched on this once per file
+            bool bigTiff = false; // magic 43: 8-byte offsets, 20-byte IFD entries
+            unsigned threads = 1; // strip/tile decoding threads (already resolved, never 0)
 
-    // ------------------------------------------------------------------
-    // Read single- or multi-IFD GeoTIFF into RasterCollection
-    // ------------------------------------------------------------------
-    inline geotiv::RasterCollection ReadRasterCollection(const fs::path &file) {
-        std::ifstream f(file, std::ios::binary);
-        if (!f)
-            throw std::runtime_error("Cannot open \"" + file.string() + "\"");
-
-        // 1) Header
-        char bom[2];
-        f.read(bom, 2);
-        bool little = (bom[0] == 'I' && bom[1] == 'I');
-        if (!little && !(bom[0] == 'M' && bom[1] == 'M'))
-            throw std::runtime_error("Bad TIFF byte-order");
-
-        auto read16 = little ? detail::readLE16 : detail::readBE16;
-        auto read32 = little ? detail::readLE32 : detail::readBE32;
-        auto read64 = little ? detail::readLE64 : detail::readBE64;
-
-        if (read16(f) != 42)
-            throw std::runtime_error("Bad TIFF magic");
-        uint32_t nextIFD = read32(f);
-
-        geotiv::RasterCollection rc;
-
-        // 2) Loop IFDs
-        bool firstIFD = true;
-        while (nextIFD) {
-            f.seekg(nextIFD, std::ios::beg);
-            uint16_t nEnt = read16(f);
-            std::map<uint16_t, detail::TIFFEntry> E;
-            for (int i = 0; i < nEnt; ++i) {
-                detail::TIFFEntry e;
-                e.tag = read16(f);
-                e.type = read16(f);
-                e.count = read32(f);
-                e.valueOffset = read32(f);
-                E[e.tag] = e;
+            /// Same byte order and flavour, reading through another cursor (one per worker thread)
+            TIFFFile fork(Cursor &other, unsigned workerThreads) const {
+                TIFFFile t{other};
+                t.little = little;
+                t.bigTiff = bigTiff;
+                t.threads = workerThreads;
+                return t;
             }
-            uint32_t currentIFDOffset = nextIFD;
-            nextIFD = read32(f);
+        };
+
+        template <bool Little> uint64_t parseHeader(TIFFFile &t, const uint8_t *head, size_t got) {
+            using E = Endian<Little>;
+            uint16_t magic = E::template load<uint16_t>(head + 2);
+            if (magic == 43) {
+                if (got < 16 || E::template load<uint16_t>(head + 4) != 8 || E::template load<uint16_t>(head + 6) != 0)
+                    throw std::runtime_error("Bad BigTIFF header");
+                t.bigTiff = true;
+                return E::template load<uint64_t>(head + 8);
+            }
+            if (magic != 42)
+                throw std::runtime_error("Bad TIFF magic");
+            return E::template load<uint32_t>(head + 4);
+        }
+
+        /// Parse the header (8 bytes, or 16 for BigTIFF), returns the offset of the first IFD.
+        inline uint64_t readHeader(TIFFFile &t) {
+            uint8_t head[16] = {};
+            size_t got = t.f.source().read(0, head, sizeof(head));
+            if (got < 8)
+                throw std::runtime_error("Failed to read TIFF header");
+            bool little = (head[0] == 'I' && head[1] == 'I');
+            if (!little && !(head[0] == 'M' && head[1] == 'M'))
+                throw std::runtime_error("Bad TIFF byte-order");
+            t.little = little;
+            return little ? parseHeader<true>(t, head, got) : parseHeader<false>(t, head, got);
+        }
+
+        /// Bytes fetched speculatively at an IFD offset: covers the whole directory of any IFD with up to
+        /// ~340 classic (or ~200 BigTIFF) entries, so typical IFDs cost exactly one read.
+        constexpr size_t kIFDReadAhead = 4096;
+
+        /// Read the directory of the IFD at ifdOffset (count, entries, next offset) as one block and decode
+        /// the entries from memory. A second read is only issued for directories larger than kIFDReadAhead.
+        template <bool Little> IFDDirectory readDirectory(TIFFFile &t, uint64_t ifdOffset, uint64_t &nextIFD) {
+            using En = Endian<Little>;
+            Source &src = t.f.source();
+            size_t countSize = t.bigTiff ? 8 : 2;
+            size_t entrySize = t.bigTiff ? 20 : 12;
+            size_t fieldSize = t.bigTiff ? 8 : 4;
+
+            std::vector<uint8_t> block(kIFDReadAhead);
+            size_t got = src.read(ifdOffset, block.data(), block.size());
+            if (got < countSize)
+                throw std::runtime_error("Failed to read IFD entry count");
+
+            uint64_t nEnt = En::uint(block.data(), countSize);
+            uint64_t needed = countSize + nEnt * entrySize + fieldSize;
+            if (nEnt > (uint64_t(1) << 32) || ifdOffset + needed > src.size())
+                throw std::runtime_error("IFD at " + std::to_string(ifdOffset) + " runs past the end of the file");
+            if (needed > got) {
+                block.resize(size_t(needed));
+                if (src.read(ifdOffset + got, block.data() + got, size_t(needed) - got) != size_t(needed) - got)
+                    throw std::runtime_error("Failed to read IFD entries");
+            }
+
+            IFDDirectory E;
+            E.entries.resize(size_t(nEnt));
+            const uint8_t *p = block.data() + countSize;
+            for (auto &e : E.entries) {
+                e.tag = En::template load<uint16_t>(p);
+                e.type = En::template load<uint16_t>(p + 2);
+                e.count = En::uint(p + 4, fieldSize);
+                std::memcpy(e.raw, p + 4 + fieldSize, fieldSize);
+                e.valueOffset = En::uint(e.raw, fieldSize);
+                p += entrySize;
+            }
+            E.finalize();
+            nextIFD = En::uint(p, fieldSize);
+            return E;
+        }
+
+        /// Parse the tags of the IFD at ifdOffset into a Layer without touching pixel strips.
+        /// The offset of the following IFD (0 for the last one) is returned through nextIFD.
+        template <bool Little> Layer readLayerMetadata(TIFFFile &t, uint64_t ifdOffset, uint64_t &nextIFD) {
+            using En = Endian<Little>;
+            Cursor &f = t.f;
+            size_t fieldSize = t.bigTiff ? 8 : 4;
+
+            IFDDirectory E = readDirectory<Little>(t, ifdOffset, nextIFD);
 
             // helpers
+            auto isInline = [&](const TIFFEntry &e) { return e.count * typeSize(e.type) <= fieldSize; };
+
+            // Raw bytes of an entry's values: the value field itself, or one block read at its offset
+            std::vector<uint8_t> block;
+            auto valueBytes = [&](const TIFFEntry &e) -> const uint8_t * {
+                if (isInline(e))
+                    return e.raw;
+                uint64_t bytes = e.count * typeSize(e.type);
+                if (e.count > f.source().size() || e.valueOffset + bytes > f.source().size())
+                    throw std::runtime_error("Tag " + std::to_string(e.tag) + " values run past the end of the file");
+                block.resize(size_t(bytes));
+                if (f.source().read(e.valueOffset, block.data(), block.size()) != block.size())
+                    throw std::runtime_error("Failed to read values of tag " + std::to_string(e.tag));
+                return block.data();
+            };
+
+            // All values of an integer tag (SHORT, LONG, LONG8, IFD8), decoded in bulk into Out
+            auto readArray = [&]<typename Out>(uint16_t tag, std::vector<Out> &out) {
+                out.clear();
+                const TIFFEntry *found = E.find(tag);
+                if (!found)
+                    return;
+                auto &e = *found;
+                if (e.type != 3 && e.type != 4 && e.type != 16 && e.type != 18)
+                    return;
+
+                const uint8_t *bytes = valueBytes(e);
+                out.resize(size_t(e.count));
+                if (e.type == 3)
+                    decodeWords<Little, uint16_t>(bytes, out.size(), out.data());
+                else if (e.type == 4)
+                    decodeWords<Little, uint32_t>(bytes, out.size(), out.data());
+                else
+                    decodeWords<Little, uint64_t>(bytes, out.size(), out.data());
+            };
+
+            auto readValues = [&](uint16_t tag) {
+                std::vector<uint64_t> out;
+                readArray(tag, out);
+                return out;
+            };
+
             auto getUInt = [&](uint16_t tag) -> uint32_t {
-                auto it = E.find(tag);
-                if (it == E.end())
+                const TIFFEntry *found = E.find(tag);
+                if (!found || found->count == 0)
                     return 0;
-                auto &e = it->second;
-                if (e.type == 3) { // SHORT
-                    if (e.count == 1) {
-                        return little ? (e.valueOffset & 0xFFFF) : ((e.valueOffset >> 16) & 0xFFFF);
-                    } else {
-                        // Multiple shorts - read from offset
-                        f.seekg(e.valueOffset, std::ios::beg);
-                        return read16(f);
-                    }
-                } else if (e.type == 4) { // LONG
-                    return e.valueOffset;
-                }
-                return 0;
+                auto &e = *found;
+                size_t size = typeSize(e.type);
+                if (e.type != 3 && e.type != 4 && e.type != 16)
+                    return 0;
+                if (isInline(e))
+                    return uint32_t(En::uint(e.raw, size));
+                // Multiple values - read the first one from the offset
+                uint8_t first[8];
+                if (f.source().read(e.valueOffset, first, size) != size)
+                    throw std::runtime_error("Failed to read tag " + std::to_string(tag));
+                return uint32_t(En::uint(first, size));
             };
 
-            auto readUInts = [&](uint16_t tag) -> std::vector<uint32_t> {
-                auto it = E.find(tag);
-                if (it == E.end())
-                    return {};
-                auto &e = it->second;
-
+            auto readUInts = [&](uint16_t tag) {
                 std::vector<uint32_t> out;
-                if (e.type == 3) { // SHORT
-                    if (e.count == 1) {
-                        uint16_t val = little ? (e.valueOffset & 0xFFFF) : ((e.valueOffset >> 16) & 0xFFFF);
-                        out.push_back(val);
-                    } else if (e.count == 2) {
-                        uint16_t val1 = little ? (e.valueOffset & 0xFFFF) : ((e.valueOffset >> 16) & 0xFFFF);
-                        uint16_t val2 = little ? ((e.valueOffset >> 16) & 0xFFFF) : (e.valueOffset & 0xFFFF);
-                        out.push_back(val1);
-                        out.push_back(val2);
-                    } else {
-                        f.seekg(e.valueOffset, std::ios::beg);
-                        for (uint32_t i = 0; i < e.count; ++i)
-                            out.push_back(read16(f));
-                    }
-                } else if (e.type == 4) { // LONG
-                    if (e.count == 1) {
-                        out.push_back(e.valueOffset);
-                    } else {
-                        f.seekg(e.valueOffset, std::ios::beg);
-                        for (uint32_t i = 0; i < e.count; ++i)
-                            out.push_back(read32(f));
-                    }
-                }
+                readArray(tag, out);
                 return out;
             };
 
             auto readDoubles = [&](uint16_t tag) -> std::vector<double> {
-                auto it = E.find(tag);
-                if (it == E.end())
+                const TIFFEntry *found = E.find(tag);
+                if (!found || found->type != 12) // 12 = DOUBLE
                     return {};
-                auto &e = it->second;
-
-                std::vector<double> out;
-                if (e.type != 12)
-                    return out; // 12 = DOUBLE
-
-                f.seekg(e.valueOffset, std::ios::beg);
-                for (uint32_t i = 0; i < e.count; ++i) {
-                    uint64_t bits = read64(f);
-                    double d;
-                    std::memcpy(&d, &bits, sizeof(d));
-                    out.push_back(d);
-                }
+
+                std::vector<uint64_t> bits(size_t(found->count));
+                decodeWords<Little, uint64_t>(valueBytes(*found), bits.size(), bits.data());
+                std::vector<double> out(bits.size());
+                if (!bits.empty())
+                    std::memcpy(out.data(), bits.data(), bits.size() * sizeof(double));
                 return out;
             };
 
             // build Layer - validate required tags
-            geotiv::Layer L;
-            L.ifdOffset = currentIFDOffset;
-            L.width = getUInt(256);  // ImageWidth
+            Layer L;
+            L.ifdOffset = ifdOffset;
+            L.subfileType = getUInt(254); // NewSubfileType
+            L.width = getUInt(256);       // ImageWidth
             L.height = getUInt(257); // ImageLength
 
             if (L.width == 0 || L.height == 0)
@@ -235,51 +318,71 @@ namespace geotiv {
             uint32_t bitsPerSample = getUInt(258);
             if (bitsPerSample == 0)
                 bitsPerSample = 1; // default
-            if (bitsPerSample != 8)
-                throw std::runtime_error("Only 8-bit samples supported, got " + std::to_string(bitsPerSample));
+            uint32_t format = getUInt(339); // SampleFormat
+            if (format == 0)
+                format = 1; // default: unsigned integer
+            L.sampleType = sampleTypeFromTiff(bitsPerSample, format);
 
-            L.stripOffsets = readUInts(273);    // StripOffsets
-            L.stripByteCounts = readUInts(279); // StripByteCounts
+            // Compression: unsupported codecs only fail once pixels are decoded, metadata stays readable
+            uint32_t compression = getUInt(259);
+            if (compression == 0)
+                compression = 1; // default: none
+            if (compression == 32946)
+                compression = 8; // old-style Deflate code, same zlib stream
+            L.compression = Compression(compression);
+            uint32_t predictor = getUInt(317); // Predictor, undone after decompression
+            L.predictor = Predictor(predictor == 0 ? 1 : predictor);
 
-            if (L.stripOffsets.empty() || L.stripByteCounts.empty())
-                throw std::runtime_error("Missing strip data");
-            if (L.stripOffsets.size() != L.stripByteCounts.size())
-                throw std::runtime_error("Mismatched strip arrays");
+            L.rowsPerStrip = getUInt(278); // RowsPerStrip
+            if (L.rowsPerStrip == 0 || L.rowsPerStrip > L.height)
+                L.rowsPerStrip = L.height; // default: single strip
 
-            // Read all strips and combine pixel data
-            size_t totalBytes = 0;
-            for (auto count : L.stripByteCounts) {
-                totalBytes += count;
-            }
+            L.tileWidth = getUInt(322);  // TileWidth
+            L.tileLength = getUInt(323); // TileLength
+            if (L.tileWidth != 0 || L.tileLength != 0) {
+                if (L.tileWidth == 0 || L.tileLength == 0)
+                    throw std::runtime_error("Incomplete tile dimensions");
 
-            size_t expectedBytes = size_t(L.width) * L.height * L.samplesPerPixel;
-            if (totalBytes != expectedBytes) {
-                throw std::runtime_error("Strip byte count mismatch: expected " + std::to_string(expectedBytes) +
-                                         ", got " + std::to_string(totalBytes));
-            }
+                L.tileOffsets = readValues(324);    // TileOffsets
+                L.tileByteCounts = readValues(325); // TileByteCounts
 
-            std::vector<uint8_t> pix(totalBytes);
-            size_t pixOffset = 0;
+                size_t tilesAcross = (L.width + L.tileWidth - 1) / L.tileWidth;
+                size_t tilesDown = (L.height + L.tileLength - 1) / L.tileLength;
+                size_t planes = L.planarConfig == 2 ? L.samplesPerPixel : 1;
+                if (L.tileOffsets.empty() || L.tileByteCounts.empty())
+                    throw std::runtime_error("Missing tile data");
+                if (L.tileOffsets.size() != L.tileByteCounts.size())
+                    throw std::runtime_error("Mismatched tile arrays");
+                if (L.tileOffsets.size() < tilesAcross * tilesDown * planes)
+                    throw std::runtime_error("Expected " + std::to_string(tilesAcross * tilesDown * planes) +
+                                             " tiles, got " + std::to_string(L.tileOffsets.size()));
+            } else {
+                L.stripOffsets = readValues(273);    // StripOffsets
+                L.stripByteCounts = readValues(279); // StripByteCounts
 
-            for (size_t i = 0; i < L.stripOffsets.size(); ++i) {
-                f.seekg(L.stripOffsets[i], std::ios::beg);
-                f.read(reinterpret_cast<char *>(pix.data() + pixOffset), L.stripByteCounts[i]);
-                if (f.gcount() != static_cast<std::streamsize>(L.stripByteCounts[i]))
-                    throw std::runtime_error("Failed to read strip data");
-                pixOffset += L.stripByteCounts[i];
+                if (L.stripOffsets.empty() || L.stripByteCounts.empty())
+                    throw std::runtime_error("Missing strip data");
+                if (L.stripOffsets.size() != L.stripByteCounts.size())
+                    throw std::runtime_error("Mismatched strip arrays");
             }
 
             // Parse geotags for each IFD independently (always WGS84)
-            concord::Datum layerDatum;                 // Will be set from ImageDescription or use a valid default
-            concord::Pose layerShift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}};  // default
-            double layerResolution = 1.0;              // default
+            concord::Datum layerDatum;                                                  // Will be set from ImageDescription or use a valid default
+            concord::Pose layerShift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}}; // default
+            double layerResolution = 1.0;                                               // default
             std::string layerDescription;
             bool datumFromDescription = false;
 
             // Parse ImageDescription for CRS/DATUM/HEADING
-            auto itD = E.find(270);
-            if (itD != E.end() && itD->second.type == 2) {
-                layerDescription = detail::readString(f, itD->second.valueOffset, itD->second.count);
+            const TIFFEntry *itD = E.find(270);
+            if (itD && itD->type == 2) {
+                if (isInline(*itD)) {
+                    // Short strings live in the value field itself
+                    layerDescription.assign(reinterpret_cast<const char *>(itD->raw), itD->count);
+                    layerDescription = layerDescription.c_str(); // stop at the NUL terminator
+                } else {
+                    layerDescription = readString(f, itD->valueOffset, itD->count);
+                }
                 std::istringstream ss(layerDescription);
                 std::string tok;
 
@@ -325,64 +428,649 @@ namespace geotiv {
             L.imageDescription = layerDescription;
 
             // Read custom tags (tag numbers 50000 and above are typically custom)
-            for (const auto &[tag, entry] : E) {
-                if (tag >= 50000) {
-                    L.customTags[tag] = readUInts(tag);
+            for (const auto &entry : E.entries) {
+                if (entry.tag >= 50000) {
+                    L.customTags[entry.tag] = readUInts(entry.tag);
+                }
+            }
+
+            return L;
+        }
+
+        /// A positioned read of a strip, a tile or a run of rows within a stored strip
+        struct BlockRead {
+            uint64_t offset = 0;
+            size_t bytes = 0;
+        };
+
+        /// The read for one strip or tile of L at offset, with `count` bytes in the file and rawBytes once
+        /// decompressed: stored blocks are read up to rawBytes, compressed ones whole.
+        inline BlockRead blockRead(const Source &src, const Layer &L, uint64_t offset, uint64_t count, size_t rawBytes,
+                                   const char *what) {
+            if (L.compression == Compression::None) {
+                if (count < rawBytes)
+                    throw std::runtime_error(std::string("Byte count mismatch in ") + what + ": expected " +
+                                             std::to_string(rawBytes) + ", got " + std::to_string(count));
+                return {offset, rawBytes};
+            }
+            if (offset > src.size() || count > src.size() - offset)
+                throw std::runtime_error(std::string("Compressed ") + what + " at " + std::to_string(offset) +
+                                         " runs past the end of the file");
+            return {offset, static_cast<size_t>(count)};
+        }
+
+        /// The rawBytes decompressed bytes (rows of rowBytes) of a block read as `packed`: stored blocks as they
+        /// are, compressed ones decoded into scratch, predictor included.
+        template <bool Little>
+        const uint8_t *unpackBlock(const Layer &L, const uint8_t *packed, size_t count, size_t rawBytes,
+                                   size_t rowBytes, std::vector<uint8_t> &scratch) {
+            if (L.compression == Compression::None)
+                return packed;
+            scratch.resize(rawBytes);
+            decodeBlock(L.compression, packed, count, scratch.data(), rawBytes);
+            if (L.predictor != Predictor::None) {
+                size_t B = sampleBytes(L.sampleType);
+                undoPredictor<Little>(L.predictor, scratch.data(), rawBytes / rowBytes, rowBytes / B,
+                                      L.planarConfig == 1 ? L.samplesPerPixel : 1, B);
+            }
+            return scratch.data();
+        }
+
+        /// Fetch every block and call use(k, bytes) with the contents of blocks[k], from up to `threads` threads.
+        /// Blocks are cut into runs handed out to the threads; each thread submits a run to the source as batches
+        /// (ByteSource::readBatch, so io_uring keeps them all in flight) and uses every block as soon as its read
+        /// completes. Sources held in memory skip the reads and pass their own bytes.
+        template <typename Use>
+        void fetchBlocks(Source &src, const std::vector<BlockRead> &blocks, unsigned threads, const char *what,
+                         Use &&use) {
+            auto failed = [&]() { return std::runtime_error(std::string("Failed to read ") + what + " data"); };
+            if (const uint8_t *mem = src.data()) {
+                parallelFor(blocks.size(), threads, [&](size_t k) {
+                    if (blocks[k].offset > src.size() || blocks[k].bytes > src.size() - blocks[k].offset)
+                        throw failed();
+                    use(k, mem + blocks[k].offset);
+                });
+                return;
+            }
+
+            constexpr size_t kBatchBlocks = 64, kBatchBytes = size_t(8) << 20;
+            size_t runs = threads > 1 ? std::min<size_t>(blocks.size(), size_t(threads) * 4) : 1;
+            parallelFor(runs, threads, [&](size_t run) {
+                size_t end = blocks.size() * (run + 1) / runs;
+                std::vector<ReadRequest> batch;
+                std::vector<uint8_t> buffer;
+                for (size_t first = blocks.size() * run / runs; first < end;) {
+                    size_t last = first, bytes = 0;
+                    while (last < end && last - first < kBatchBlocks && (last == first || bytes < kBatchBytes))
+                        bytes += blocks[last++].bytes;
+                    buffer.resize(bytes);
+                    batch.clear();
+                    for (size_t k = first, at = 0; k < last; at += blocks[k++].bytes)
+                        batch.push_back({blocks[k].offset, buffer.data() + at, blocks[k].bytes});
+                    src.readBatch(batch, [&](size_t i, size_t got) {
+                        if (got != batch[i].n)
+                            throw failed();
+                        use(first + i, static_cast<const uint8_t *>(batch[i].dst));
+                    });
+                    first = last;
                 }
+            });
+        }
+
+        /// Copy rows [row0, row0+rows) x cols [col0, col0+cols) of the first sample plane into grid,
+        /// reading only the tiles that intersect the window. Edge tiles are padded in the file and cropped here.
+        /// Tiles are fetched in batches by `threads` threads, each decompressing its tiles as they arrive and
+        /// filling its own cells.
+        /// Instantiated per byte order and sample type T, so the copy loop is a plain (byte-swapping) load.
+        template <bool Little, typename T>
+        void readTileWindow(Source &src, const Layer &L, uint32_t row0, uint32_t col0, uint32_t rows, uint32_t cols,
+                            concord::Grid<T> &grid, unsigned threads) {
+            size_t pixelStride = (L.planarConfig == 1 ? L.samplesPerPixel : 1) * sizeof(T);
+            size_t tileRowBytes = size_t(L.tileWidth) * pixelStride;
+            size_t tileBytes = tileRowBytes * L.tileLength;
+            uint32_t tilesAcross = (L.width + L.tileWidth - 1) / L.tileWidth;
+
+            uint32_t firstTileRow = row0 / L.tileLength, lastTileRow = (row0 + rows - 1) / L.tileLength;
+            uint32_t firstTileCol = col0 / L.tileWidth, lastTileCol = (col0 + cols - 1) / L.tileWidth;
+            uint32_t windowTilesAcross = lastTileCol - firstTileCol + 1;
+            size_t count = size_t(lastTileRow - firstTileRow + 1) * windowTilesAcross;
+
+            auto tileIndex = [&](size_t k) {
+                uint32_t ty = firstTileRow + uint32_t(k / windowTilesAcross);
+                uint32_t tx = firstTileCol + uint32_t(k % windowTilesAcross);
+                return size_t(ty) * tilesAcross + tx;
+            };
+            std::vector<BlockRead> blocks(count);
+            for (size_t k = 0; k < count; ++k) {
+                size_t idx = tileIndex(k);
+                blocks[k] = blockRead(src, L, L.tileOffsets[idx], L.tileByteCounts[idx], tileBytes, "tile");
             }
 
-            // Set collection defaults from first IFD if not set
-            if (firstIFD) {
-                firstIFD = false;
-                rc.datum = layerDatum;
-                rc.shift = layerShift;
-                rc.resolution = layerResolution;
+            fetchBlocks(src, blocks, threads, "tile", [&](size_t k, const uint8_t *packed) {
+                std::vector<uint8_t> scratch;
+                const uint8_t *tile = unpackBlock<Little>(L, packed, blocks[k].bytes, tileBytes, tileRowBytes, scratch);
+                uint32_t ty = uint32_t(tileIndex(k) / tilesAcross), tx = uint32_t(tileIndex(k) % tilesAcross);
+
+                // Intersection of this tile with the window, in image coordinates
+                uint32_t r0 = std::max(row0, ty * L.tileLength);
+                uint32_t r1 = std::min(row0 + rows, (ty + 1) * L.tileLength);
+                uint32_t c0 = std::max(col0, tx * L.tileWidth);
+                uint32_t c1 = std::min(col0 + cols, (tx + 1) * L.tileWidth);
+                for (uint32_t r = r0; r < r1; ++r) {
+                    const uint8_t *row = tile + size_t(r - ty * L.tileLength) * tileRowBytes;
+                    for (uint32_t c = c0; c < c1; ++c) {
+                        grid(r - row0, c - col0) =
+                            Endian<Little>::template load<T>(row + size_t(c - tx * L.tileWidth) * pixelStride);
+                    }
+                }
+            });
+        }
+
+        /// Copy rows [row0, row0+rows) x cols [col0, col0+cols) of the first sample plane into grid.
+        /// Stored strips are read only over the byte ranges the window needs; compressed strips are read and
+        /// decoded whole. All reads go out in batches from `threads` threads, each filling the rows it fetched.
+        template <bool Little, typename T>
+        void readStripWindow(Source &src, const Layer &L, uint32_t row0, uint32_t col0, uint32_t rows, uint32_t cols,
+                             concord::Grid<T> &grid, unsigned threads) {
+            size_t pixelStride = (L.planarConfig == 1 ? L.samplesPerPixel : 1) * sizeof(T);
+            size_t rowBytes = size_t(L.width) * pixelStride;
+            size_t spanBytes = size_t(cols) * pixelStride;
+            uint32_t stripsPerPlane = (L.height + L.rowsPerStrip - 1) / L.rowsPerStrip;
+            if (L.stripOffsets.size() < stripsPerPlane)
+                throw std::runtime_error("Strip count does not cover image height");
+
+            // Row r of the image, starting at column col0, into grid row r - row0
+            auto copyRow = [&](const uint8_t *row, uint32_t r) {
+                for (uint32_t c = 0; c < cols; ++c) {
+                    grid(r - row0, c) = Endian<Little>::template load<T>(row + c * pixelStride);
+                }
+            };
+
+            // One read per compressed strip; stored strips need one read of whole rows, or one read per row when
+            // the window is narrower than the image. firstRow[k] is the image row read k starts at.
+            std::vector<BlockRead> blocks;
+            std::vector<uint32_t> firstRow;
+            uint32_t firstStrip = row0 / L.rowsPerStrip;
+            uint32_t lastStrip = (row0 + rows - 1) / L.rowsPerStrip;
+            bool fullRows = (spanBytes == rowBytes);
+            for (uint32_t s = firstStrip; s <= lastStrip; ++s) {
+                uint32_t stripRow0 = s * L.rowsPerStrip;
+                uint32_t stripRow1 = std::min(stripRow0 + L.rowsPerStrip, L.height);
+                uint32_t r0 = std::max(row0, stripRow0);
+                uint32_t r1 = std::min(row0 + rows, stripRow1);
+
+                if (L.compression != Compression::None) {
+                    blocks.push_back(blockRead(src, L, L.stripOffsets[s], L.stripByteCounts[s],
+                                               size_t(stripRow1 - stripRow0) * rowBytes, "strip"));
+                    firstRow.push_back(stripRow0);
+                    continue;
+                }
+
+                if (size_t(r1 - stripRow0) * rowBytes > L.stripByteCounts[s])
+                    throw std::runtime_error("Strip byte count too small for window");
+                for (uint32_t r = r0; r < r1; r = fullRows ? r1 : r + 1) {
+                    uint64_t at = L.stripOffsets[s] + size_t(r - stripRow0) * rowBytes + size_t(col0) * pixelStride;
+                    blocks.push_back({at, fullRows ? size_t(r1 - r0) * rowBytes : spanBytes});
+                    firstRow.push_back(r);
+                }
             }
 
+            fetchBlocks(src, blocks, threads, "strip", [&](size_t k, const uint8_t *packed) {
+                uint32_t r = firstRow[k];
+                if (L.compression != Compression::None) {
+                    uint32_t stripRow1 = std::min(r + L.rowsPerStrip, L.height);
+                    std::vector<uint8_t> scratch;
+                    const uint8_t *strip = unpackBlock<Little>(L, packed, blocks[k].bytes,
+                                                               size_t(stripRow1 - r) * rowBytes, rowBytes, scratch);
+                    for (uint32_t rr = std::max(row0, r); rr < std::min(row0 + rows, stripRow1); ++rr)
+                        copyRow(strip + size_t(rr - r) * rowBytes + size_t(col0) * pixelStride, rr);
+                    return;
+                }
+                for (size_t j = 0; j < blocks[k].bytes / spanBytes; ++j)
+                    copyRow(packed + j * spanBytes, r + uint32_t(j));
+            });
+        }
+
+        /// Decode rows [row0, row0+rows) x cols [col0, col0+cols) of L into a grid of its sample type centered on
+        /// shift. Byte order and sample type are dispatched here once; the loops run fully specialized.
+        inline SampleGrid decodeWindow(TIFFFile &t, const Layer &L, uint32_t row0, uint32_t col0, uint32_t rows,
+                                       uint32_t cols, const concord::Pose &shift) {
+            return withSampleType(L.sampleType, [&](auto type) -> SampleGrid {
+                using T = typename decltype(type)::type;
+                concord::Grid<T> grid(rows, cols, L.resolution, true, shift);
+                auto fill = [&](auto little) {
+                    constexpr bool Little = decltype(little)::value;
+                    if (L.isTiled())
+                        readTileWindow<Little>(t.f.source(), L, row0, col0, rows, cols, grid, t.threads);
+                    else
+                        readStripWindow<Little>(t.f.source(), L, row0, col0, rows, cols, grid, t.threads);
+                };
+                if (t.little)
+                    fill(std::true_type{});
+                else
+                    fill(std::false_type{});
+                return grid;
+            });
+        }
+
+        /// Read the strips or tiles of a layer whose metadata was parsed by readLayerMetadata into a grid.
+        inline SampleGrid decodeLayerPixels(TIFFFile &t, const Layer &L) {
             // Build geo-grid using layer-specific resolution and datum
             if (!L.datum.is_set()) {
                 throw std::runtime_error("Datum not properly initialized for layer");
             }
 
+            if (!L.isTiled() && L.compression == Compression::None) {
+                size_t totalBytes = 0;
+                for (auto count : L.stripByteCounts) {
+                    totalBytes += size_t(count);
+                }
+
+                size_t expectedBytes = size_t(L.width) * L.height * L.samplesPerPixel * sampleBytes(L.sampleType);
+                if (totalBytes != expectedBytes) {
+                    throw std::runtime_error("Strip byte count mismatch: expected " + std::to_string(expectedBytes) +
+                                             ", got " + std::to_string(totalBytes));
+                }
+            }
+
+            // Fill grid with the first sample of every pixel (chunky) or the first plane (planar).
             // Use the shift directly - it's already in ENU space
-            concord::Pose shift = L.shift;
-
-            concord::Grid<uint8_t> grid(
-                /*rows=*/L.height,
-                /*cols=*/L.width,
-                /*diameter=*/L.resolution,
-                /*centered=*/true,
-                /*shift=*/shift);
-
-            // Fill grid with pixel data
-            if (L.planarConfig == 1) { // Chunky format
-                size_t idx = 0;
-                for (uint32_t r = 0; r < L.height; ++r) {
-                    for (uint32_t c = 0; c < L.width; ++c) {
-                        // For multi-sample pixels, take first sample
-                        grid(r, c) = pix[idx];
-                        idx += L.samplesPerPixel;
-                    }
+            return decodeWindow(t, L, 0, 0, L.height, L.width, L.shift);
+        }
+
+        inline void readLayerPixels(TIFFFile &t, Layer &L) { L.setSamples(decodeLayerPixels(t, L)); }
+
+        /// Defer readLayerPixels until the layer is materialized; the loader keeps the source open.
+        inline void deferLayerPixels(const std::shared_ptr<Source> &src, const TIFFFile &file, Layer &L) {
+            Layer meta;
+            meta.width = L.width;
+            meta.height = L.height;
+            meta.samplesPerPixel = L.samplesPerPixel;
+            meta.planarConfig = L.planarConfig;
+            meta.sampleType = L.sampleType;
+            meta.compression = L.compression;
+            meta.predictor = L.predictor;
+            meta.rowsPerStrip = L.rowsPerStrip;
+            meta.stripOffsets = L.stripOffsets;
+            meta.stripByteCounts = L.stripByteCounts;
+            meta.tileWidth = L.tileWidth;
+            meta.tileLength = L.tileLength;
+            meta.tileOffsets = L.tileOffsets;
+            meta.tileByteCounts = L.tileByteCounts;
+            meta.datum = L.datum;
+            meta.shift = L.shift;
+            meta.resolution = L.resolution;
+
+            bool little = file.little;
+            unsigned threads = file.threads;
+            L.gridLoader = [src, little, threads, meta]() {
+                Cursor f(*src);
+                TIFFFile t{f};
+                t.little = little;
+                t.threads = threads;
+                return decodeLayerPixels(t, meta);
+            };
+        }
+
+        /// Offset of the IFD following the one at ifdOffset, without parsing its entries. With `reduced`, also
+        /// tells whether the IFD is a reduced-resolution image (NewSubfileType bit 0) from its first entry:
+        /// entries are sorted by tag, so tag 254 comes first when present.
+        template <bool Little> uint64_t skipIFD(TIFFFile &t, uint64_t ifdOffset, bool *reduced = nullptr) {
+            using En = Endian<Little>;
+            Source &src = t.f.source();
+            size_t countSize = t.bigTiff ? 8 : 2;
+            size_t fieldSize = t.bigTiff ? 8 : 4;
+            uint8_t buf[8];
+            if (src.read(ifdOffset, buf, countSize) != countSize)
+                throw std::runtime_error("Failed to read IFD entry count");
+            uint64_t nEnt = Endian<Little>::uint(buf, countSize);
+            if (nEnt > (uint64_t(1) << 32))
+                throw std::runtime_error("IFD at " + std::to_string(ifdOffset) + " runs past the end of the file");
+            if (reduced) {
+                *reduced = false;
+                uint8_t e[20];
+                size_t entrySize = t.bigTiff ? 20 : 12;
+                if (nEnt > 0 && src.read(ifdOffset + countSize, e, entrySize) == entrySize &&
+                    En::template load<uint16_t>(e) == 254) {
+                    const uint8_t *v = e + 4 + fieldSize; // value field, left-justified
+                    uint32_t type = En::template load<uint16_t>(e + 2);
+                    *reduced = ((type == 3 ? En::template load<uint16_t>(v) : En::template load<uint32_t>(v)) & 1) != 0;
+                }
+            }
+            if (src.read(ifdOffset + countSize + nEnt * (t.bigTiff ? 20 : 12), buf, fieldSize) != fieldSize)
+                throw std::runtime_error("Failed to read next IFD offset");
+            return Endian<Little>::uint(buf, fieldSize);
+        }
+
+        /// ENU pose of the center of a pixel window, rows run south and columns east in the layer's frame.
+        inline concord::Pose windowShift(const Layer &L, double row0, double col0, double rows, double cols) {
+            double dx = (col0 + cols / 2.0 - L.width / 2.0) * L.resolution;
+            double dy = -(row0 + rows / 2.0 - L.height / 2.0) * L.resolution;
+            double yaw = L.shift.angle.yaw;
+            concord::Pose out = L.shift;
+            out.point.x += dx * std::cos(yaw) - dy * std::sin(yaw);
+            out.point.y += dx * std::sin(yaw) + dy * std::cos(yaw);
+            return out;
+        }
+
+        enum class PixelMode { Skip, Eager, Lazy };
+
+        /// Whether an IFD read as L is an overview of the layer before it: reduced resolution, and not the first
+        inline bool isOverview(const Layer &L, bool first) { return !first && (L.subfileType & 1); }
+
+        /// L as read at its coarsest level whose pixels are at most `target` meters wide (L itself for target 0 or
+        /// below L's resolution). A level takes L's geo-reference and tags, with the resolution scaled by its width
+        /// since overview IFDs often carry no geotags of their own.
+        inline Layer levelFor(const Layer &L, double target) {
+            const Layer *best = nullptr;
+            double bestResolution = L.resolution;
+            for (auto const &ov : L.overviews) {
+                if (target <= 0 || ov.width == 0)
+                    continue;
+                double resolution = L.resolution * double(L.width) / ov.width;
+                if (resolution <= target * (1 + 1e-9) && resolution > bestResolution) {
+                    best = &ov;
+                    bestResolution = resolution;
                 }
-            } else { // Planar format
-                // Take first plane only
-                size_t idx = 0;
-                for (uint32_t r = 0; r < L.height; ++r) {
-                    for (uint32_t c = 0; c < L.width; ++c) {
-                        grid(r, c) = pix[idx++];
+            }
+            if (!best)
+                return L;
+            Layer level = *best;
+            level.subfileType = 0;
+            level.datum = L.datum;
+            level.shift = L.shift;
+            level.resolution = bestResolution;
+            level.imageDescription = L.imageDescription;
+            level.customTags = L.customTags;
+            // Only the levels coarser than the one picked are still overviews of it
+            for (auto const &ov : L.overviews)
+                if (ov.width < best->width)
+                    level.overviews.push_back(ov);
+            return level;
+        }
+
+        /// Walk the IFD chain from nextIFD, then handle each layer's pixels according to mode.
+        /// Overview IFDs are attached to the layer before them as metadata, and every layer is swapped for its
+        /// level picked by targetResolution before any pixels are read. Eager reads with more than one thread
+        /// decode whole layers concurrently, keeping file order.
+        template <bool Little>
+        RasterCollection walkCollection(const std::shared_ptr<Source> &src, TIFFFile &t, uint64_t nextIFD,
+                                        PixelMode mode, double targetResolution) {
+            RasterCollection rc;
+            while (nextIFD) {
+                Layer L = readLayerMetadata<Little>(t, nextIFD, nextIFD);
+                if (isOverview(L, rc.layers.empty()))
+                    rc.layers.back().overviews.push_back(std::move(L));
+                else
+                    rc.layers.push_back(std::move(L));
+            }
+
+            if (rc.layers.empty()) {
+                throw std::runtime_error("No valid IFDs found in TIFF file");
+            }
+
+            if (targetResolution > 0) {
+                for (auto &L : rc.layers)
+                    L = levelFor(L, targetResolution);
+            }
+
+            // Set collection defaults from first IFD
+            rc.datum = rc.layers.front().datum;
+            rc.shift = rc.layers.front().shift;
+            rc.resolution = rc.layers.front().resolution;
+
+            if (mode == PixelMode::Eager) {
+                // Threads left over when there are fewer layers than threads go to each layer's strips/tiles
+                size_t N = rc.layers.size();
+                unsigned perLayer = std::max<unsigned>(1, t.threads / unsigned(N));
+                parallelFor(N, t.threads, [&](size_t i) {
+                    Cursor c(*src);
+                    TIFFFile lt = t.fork(c, perLayer);
+                    readLayerPixels(lt, rc.layers[i]);
+                });
+            } else if (mode == PixelMode::Lazy) {
+                for (auto &L : rc.layers)
+                    deferLayerPixels(src, t, L);
+            }
+            return rc;
+        }
+
+        inline Source &checkedSource(const std::shared_ptr<Source> &src) {
+            if (!src)
+                throw std::invalid_argument("Null ByteSource");
+            return *src;
+        }
+
+        /// Read the header of src and run the parser instantiated for its byte order.
+        inline RasterCollection readCollection(const std::shared_ptr<Source> &src, const ReadOptions &opts,
+                                               PixelMode mode) {
+            Cursor f(checkedSource(src));
+            TIFFFile t{f};
+            t.threads = resolveThreads(opts.threads);
+
+            uint64_t first = readHeader(t);
+            double target = opts.targetResolution;
+            return t.little ? walkCollection<true>(src, t, first, mode, target)
+                            : walkCollection<false>(src, t, first, mode, target);
+        }
+
+        inline RasterCollection readCollection(const fs::path &file, const ReadOptions &opts, PixelMode mode) {
+            return readCollection(openSource(file, opts), opts, mode);
+        }
+    } // namespace detail
+
+    // ------------------------------------------------------------------
+    // Read single- or multi-IFD GeoTIFF into RasterCollection
+    // ------------------------------------------------------------------
+    /// opts.backend selects how bytes are fetched (ifstream or mmap); the result is identical either way.
+    /// With opts.lazy every grid stays empty until Layer::materialize() decodes it from the open file.
+    /// With opts.targetResolution each layer is replaced by its coarsest level at least that fine.
+    inline geotiv::RasterCollection ReadRasterCollection(const fs::path &file, const ReadOptions &opts = {}) {
+        return detail::readCollection(file, opts, opts.lazy ? detail::PixelMode::Lazy : detail::PixelMode::Eager);
+    }
+
+    /// Same as above from any ByteSource (opts.backend and opts.access only apply to files).
+    /// Lazy layers keep the source alive until they are materialized.
+    inline geotiv::RasterCollection ReadRasterCollection(const std::shared_ptr<ByteSource> &src,
+                                                         const ReadOptions &opts = {}) {
+        return detail::readCollection(src, opts, opts.lazy ? detail::PixelMode::Lazy : detail::PixelMode::Eager);
+    }
+
+    /// Parse a TIFF held in memory, e.g. from toTiffBytes(), without copying it: pixels are decoded straight out of
+    /// bytes. With opts.lazy the bytes must stay alive until every layer is materialized.
+    inline geotiv::RasterCollection fromTiffBytes(std::span<const uint8_t> bytes, const ReadOptions &opts = {}) {
+        return ReadRasterCollection(std::make_shared<SpanSource>(bytes), opts);
+    }
+
+    // ------------------------------------------------------------------
+    // Metadata-only scan: walk the IFD chain, never read pixel strips
+    // ------------------------------------------------------------------
+    /// Same layers/tags/geo metadata as ReadRasterCollection (at the same levels), but every Layer::grid is left empty.
+    inline geotiv::RasterCollection ReadRasterMetadata(const fs::path &file, const ReadOptions &opts = {}) {
+        return detail::readCollection(file, opts, detail::PixelMode::Skip);
+    }
+
+    inline geotiv::RasterCollection ReadRasterMetadata(const std::shared_ptr<ByteSource> &src,
+                                                       const ReadOptions &opts = {}) {
+        return detail::readCollection(src, opts, detail::PixelMode::Skip);
+    }
+
+    // ------------------------------------------------------------------
+    // Windowed reads: fetch only the strips or tiles that intersect a pixel window
+    // ------------------------------------------------------------------
+    namespace detail {
+        struct PixelWindow {
+            uint32_t row0 = 0, col0 = 0, rows = 0, cols = 0;
+        };
+
+        /// Metadata of the layerIndex-th layer, skipping the entries of the IFDs before it. Overview IFDs are not
+        /// counted as layers, as in ReadRasterCollection; with withOverviews the ones following the layer are read
+        /// into Layer::overviews.
+        template <bool Little> Layer findLayerAs(TIFFFile &t, uint64_t ifd, size_t layerIndex, bool withOverviews) {
+            size_t seen = 0;
+            for (bool first = true; ifd; first = false) {
+                bool reduced = false;
+                uint64_t next = skipIFD<Little>(t, ifd, &reduced);
+                if ((first || !reduced) && seen++ == layerIndex) {
+                    Layer L = readLayerMetadata<Little>(t, ifd, next);
+                    while (withOverviews && next) {
+                        uint64_t at = next;
+                        skipIFD<Little>(t, at, &reduced);
+                        if (!reduced)
+                            break;
+                        L.overviews.push_back(readLayerMetadata<Little>(t, at, next));
                     }
+                    return L;
+                }
+                ifd = next;
+            }
+            throw std::out_of_range("ReadWindow(): layer index " + std::to_string(layerIndex) + " out of range");
+        }
+
+        inline Layer findLayer(TIFFFile &t, size_t layerIndex, bool withOverviews = false) {
+            uint64_t first = readHeader(t);
+            return t.little ? findLayerAs<true>(t, first, layerIndex, withOverviews)
+                            : findLayerAs<false>(t, first, layerIndex, withOverviews);
+        }
+
+        /// The layerIndex-th layer at the level ReadOptions::targetResolution picks for it
+        inline Layer findLevel(TIFFFile &t, size_t layerIndex, double targetResolution) {
+            return levelFor(findLayer(t, layerIndex, targetResolution > 0), targetResolution);
+        }
+
+        inline void checkWindow(const Layer &L, const PixelWindow &w) {
+            if (w.rows == 0 || w.cols == 0)
+                throw std::out_of_range("ReadWindow(): empty window");
+            if (uint64_t(w.row0) + w.rows > L.height || uint64_t(w.col0) + w.cols > L.width)
+                throw std::out_of_range("ReadWindow(): window exceeds " + std::to_string(L.width) + "x" +
+                                        std::to_string(L.height) + " layer");
+        }
+
+        /// The pixel window w of `from` in the pixels of `to`, another level of the same layer (rounded outwards)
+        inline PixelWindow scaleWindow(const Layer &from, const Layer &to, const PixelWindow &w) {
+            if (from.width == to.width && from.height == to.height)
+                return w;
+            double fx = double(to.width) / from.width, fy = double(to.height) / from.height;
+            auto r0 = std::min(to.height - 1, uint32_t(std::floor(w.row0 * fy)));
+            auto c0 = std::min(to.width - 1, uint32_t(std::floor(w.col0 * fx)));
+            auto r1 = std::min(to.height, uint32_t(std::ceil((double(w.row0) + w.rows) * fy)));
+            auto c1 = std::min(to.width, uint32_t(std::ceil((double(w.col0) + w.cols) * fx)));
+            return {r0, c0, std::max<uint32_t>(1, r1 - r0), std::max<uint32_t>(1, c1 - c0)};
+        }
+
+        /// Pixel window covering an ENU box, clamped to the layer bounds.
+        inline PixelWindow windowFromBox(const Layer &L, const concord::Point &enuMin, const concord::Point &enuMax) {
+            // Corners of the box in continuous pixel coordinates (origin at the top-left image corner)
+            double yaw = L.shift.angle.yaw;
+            double minC = 1e300, maxC = -1e300, minR = 1e300, maxR = -1e300;
+            for (double x : {enuMin.x, enuMax.x}) {
+                for (double y : {enuMin.y, enuMax.y}) {
+                    double ex = x - L.shift.point.x;
+                    double ey = y - L.shift.point.y;
+                    double lx = ex * std::cos(yaw) + ey * std::sin(yaw);
+                    double ly = -ex * std::sin(yaw) + ey * std::cos(yaw);
+                    double c = lx / L.resolution + L.width / 2.0;
+                    double r = -ly / L.resolution + L.height / 2.0;
+                    minC = std::min(minC, c);
+                    maxC = std::max(maxC, c);
+                    minR = std::min(minR, r);
+                    maxR = std::max(maxR, r);
                 }
             }
 
-            L.grid = std::move(grid);
-            rc.layers.emplace_back(std::move(L));
+            double c0 = std::max(0.0, std::floor(minC));
+            double c1 = std::min(double(L.width), std::ceil(maxC));
+            double r0 = std::max(0.0, std::floor(minR));
+            double r1 = std::min(double(L.height), std::ceil(maxR));
+            if (c1 <= c0 || r1 <= r0)
+                throw std::out_of_range("ReadWindow(): box does not intersect layer");
+            return {uint32_t(r0), uint32_t(c0), uint32_t(r1 - r0), uint32_t(c1 - c0)};
         }
 
-        if (rc.layers.empty()) {
-            throw std::runtime_error("No valid IFDs found in TIFF file");
+        /// Turn layer metadata L into the window w of itself, reading only the intersecting strips or tiles.
+        inline Layer readWindow(TIFFFile &t, Layer L, const PixelWindow &w) {
+            checkWindow(L, w);
+
+            concord::Pose shift = windowShift(L, w.row0, w.col0, w.rows, w.cols);
+            SampleGrid grid = decodeWindow(t, L, w.row0, w.col0, w.rows, w.cols, shift);
+
+            L.width = w.cols;
+            L.height = w.rows;
+            L.shift = shift;
+            L.rowsPerStrip = 0;
+            L.stripOffsets.clear();
+            L.stripByteCounts.clear();
+            L.tileWidth = 0;
+            L.tileLength = 0;
+            L.tileOffsets.clear();
+            L.tileByteCounts.clear();
+            L.overviews.clear();
+            L.setSamples(std::move(grid));
+            return L;
         }
+    } // namespace detail
+
+    /// Read rows [row0, row0+rows) x cols [col0, col0+cols) of the layerIndex-th layer of source.
+    /// The returned Layer carries the source layer's metadata, the window's width/height and a shift
+    /// centered on the window; strip/tile layout fields are cleared since they describe the file.
+    /// With opts.targetResolution the window, given in full-resolution pixels, is read from the picked overview
+    /// and grows outwards to whole pixels of that level.
+    inline geotiv::Layer ReadWindow(const std::shared_ptr<ByteSource> &source, size_t layerIndex, uint32_t row0,
+                                    uint32_t col0, uint32_t rows, uint32_t cols, const ReadOptions &opts = {}) {
+        detail::Cursor f(detail::checkedSource(source));
+        detail::TIFFFile t{f};
+        t.threads = detail::resolveThreads(opts.threads);
+        Layer full = detail::findLayer(t, layerIndex, opts.targetResolution > 0);
+        detail::PixelWindow w{row0, col0, rows, cols};
+        detail::checkWindow(full, w);
+        Layer L = detail::levelFor(full, opts.targetResolution);
+        return detail::readWindow(t, std::move(L), detail::scaleWindow(full, L, w));
+    }
+
+    /// Read the part of a layer covered by the ENU box [enuMin, enuMax], in meters relative to the layer's datum.
+    /// The box is mapped into the layer's rotated pixel frame and clamped to the layer bounds; with
+    /// opts.targetResolution it is cut from the overview level that resolution picks.
+    inline geotiv::Layer ReadWindow(const std::shared_ptr<ByteSource> &source, size_t layerIndex,
+                                    const concord::Point &enuMin, const concord::Point &enuMax,
+                                    const ReadOptions &opts = {}) {
+        detail::Cursor f(detail::checkedSource(source));
+        detail::TIFFFile t{f};
+        t.threads = detail::resolveThreads(opts.threads);
+        Layer L = detail::findLevel(t, layerIndex, opts.targetResolution);
+        auto w = detail::windowFromBox(L, enuMin, enuMax);
+        return detail::readWindow(t, std::move(L), w);
+    }
+
+    /// Read the part of a layer covered by the WGS84 box spanned by two opposite corners.
+    inline geotiv::Layer ReadWindow(const std::shared_ptr<ByteSource> &source, size_t layerIndex,
+                                    const concord::WGS &corner1, const concord::WGS &corner2,
+                                    const ReadOptions &opts = {}) {
+        detail::Cursor f(detail::checkedSource(source));
+        detail::TIFFFile t{f};
+        t.threads = detail::resolveThreads(opts.threads);
+        Layer L = detail::findLevel(t, layerIndex, opts.targetResolution);
+        concord::ENU a = corner1.toENU(L.datum);
+        concord::ENU b = corner2.toENU(L.datum);
+        concord::Point enuMin{std::min(a.x, b.x), std::min(a.y, b.y), 0};
+        concord::Point enuMax{std::max(a.x, b.x), std::max(a.y, b.y), 0};
+        auto w = detail::windowFromBox(L, enuMin, enuMax);
+        return detail::readWindow(t, std::move(L), w);
+    }
+
+    /// The ReadWindow overloads above on a file, opened with opts.backend
+    inline geotiv::Layer ReadWindow(const fs::path &file, size_t layerIndex, uint32_t row0, uint32_t col0,
+                                    uint32_t rows, uint32_t cols, const ReadOptions &opts = {}) {
+        return ReadWindow(openByteSource(file, opts), layerIndex, row0, col0, rows, cols, opts);
+    }
+
+    inline geotiv::Layer ReadWindow(const fs::path &file, size_t layerIndex, const concord::Point &enuMin,
+                                    const concord::Point &enuMax, const ReadOptions &opts = {}) {
+        return ReadWindow(openByteSource(file, opts), layerIndex, enuMin, enuMax, opts);
+    }
 
-        return rc;
+    inline geotiv::Layer ReadWindow(const fs::path &file, size_t layerIndex, const concord::WGS &corner1,
+                                    const concord::WGS &corner2, const ReadOptions &opts = {}) {
+        return ReadWindow(openByteSource(file, opts), layerIndex, corner1, corner2, opts);
     }
 
     // ------------------------------------------------------------------
@@ -397,7 +1085,12 @@ namespace geotiv {
            << " Layers:     " << rc.layers.size() << "\n";
         for (auto const &L : rc.layers) {
             os << "  IFD@0x" << std::hex << L.ifdOffset << std::dec << " → " << L.width << "×" << L.height
-               << ", SPP=" << L.samplesPerPixel << ", PC=" << L.planarConfig << "\n";
+               << ", SPP=" << L.samplesPerPixel << ", PC=" << L.planarConfig;
+            if (L.isTiled())
+                os << ", tiles " << L.tileWidth << "×" << L.tileLength;
+            if (!L.overviews.empty())
+                os << ", " << L.overviews.size() << " overviews";
+            os << "\n";
         }
         return os;
     }
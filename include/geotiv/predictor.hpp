@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "geotiv/endian.hpp"
+#include "geotiv/simd.hpp"
+#include "geotiv/types.hpp" // Predictor
+
+namespace geotiv {
+    namespace detail {
+#if GEOTIV_HAS_SSE2
+        template <typename U> __m128i addLanes(__m128i a, __m128i b) {
+            if constexpr (sizeof(U) == 1)
+                return _mm_add_epi8(a, b);
+            else if constexpr (sizeof(U) == 2)
+                return _mm_add_epi16(a, b);
+            else if constexpr (sizeof(U) == 4)
+                return _mm_add_epi32(a, b);
+            else
+                return _mm_add_epi64(a, b);
+        }
+
+        template <typename U> __m128i subLanes(__m128i a, __m128i b) {
+            if constexpr (sizeof(U) == 1)
+                return _mm_sub_epi8(a, b);
+            else if constexpr (sizeof(U) == 2)
+                return _mm_sub_epi16(a, b);
+            else if constexpr (sizeof(U) == 4)
+                return _mm_sub_epi32(a, b);
+            else
+                return _mm_sub_epi64(a, b);
+        }
+
+        template <typename U> __m128i splat(U v) {
+            if constexpr (sizeof(U) == 1)
+                return _mm_set1_epi8(char(v));
+            else if constexpr (sizeof(U) == 2)
+                return _mm_set1_epi16(short(v));
+            else if constexpr (sizeof(U) == 4)
+                return _mm_set1_epi32(int(v));
+            else
+                return _mm_set1_epi64x((long long)v);
+        }
+
+        /// Inclusive prefix sum of the lanes of x in log2(lanes) shift-and-add steps
+        template <typename U> __m128i prefixLanes(__m128i x) {
+            x = addLanes<U>(x, _mm_slli_si128(x, sizeof(U)));
+            if constexpr (sizeof(U) <= 4)
+                x = addLanes<U>(x, _mm_slli_si128(x, 2 * sizeof(U)));
+            if constexpr (sizeof(U) <= 2)
+                x = addLanes<U>(x, _mm_slli_si128(x, 4 * sizeof(U)));
+            if constexpr (sizeof(U) == 1)
+                x = addLanes<U>(x, _mm_slli_si128(x, 8));
+            return x;
+        }
+#endif
+#if GEOTIV_HAS_AVX2
+        template <typename U> __m256i subLanes256(__m256i a, __m256i b) {
+            if constexpr (sizeof(U) == 1)
+                return _mm256_sub_epi8(a, b);
+            else if constexpr (sizeof(U) == 2)
+                return _mm256_sub_epi16(a, b);
+            else if constexpr (sizeof(U) == 4)
+                return _mm256_sub_epi32(a, b);
+            else
+                return _mm256_sub_epi64(a, b);
+        }
+#endif
+
+        // ------------------------------------------------------------------
+        // Predictor 2: horizontal differencing of unsigned samples U (wrapping), one row at a time
+        // ------------------------------------------------------------------
+        /// Replace each of the n samples of a row (byte order Little) by its difference to the same sample
+        /// `stride` samples to the left. Runs right to left so every block reads its inputs before they change.
+        template <bool Little, typename U> void differenceRow(uint8_t *row, size_t n, size_t stride) {
+            using En = Endian<Little>;
+            size_t i = n;
+            if constexpr (Little == kHostLittle) {
+#if GEOTIV_HAS_AVX2
+                constexpr size_t lanes256 = 32 / sizeof(U);
+                while (i >= stride + lanes256) {
+                    i -= lanes256;
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i * sizeof(U)));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + (i - stride) * sizeof(U)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + i * sizeof(U)), subLanes256<U>(a, b));
+                }
+#endif
+#if GEOTIV_HAS_SSE2
+                constexpr size_t lanes = 16 / sizeof(U);
+                while (i >= stride + lanes) {
+                    i -= lanes;
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i * sizeof(U)));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + (i - stride) * sizeof(U)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i * sizeof(U)), subLanes<U>(a, b));
+                }
+#endif
+            }
+            while (i > stride) {
+                --i;
+                U v = En::template load<U>(row + i * sizeof(U));
+                U left = En::template load<U>(row + (i - stride) * sizeof(U));
+                En::store(row + i * sizeof(U), U(v - left));
+            }
+        }
+
+        /// Undo differenceRow: a running sum per sample channel. With one sample per pixel the sum is computed
+        /// a register at a time (in-register prefix sum plus the carried last value of the previous register).
+        template <bool Little, typename U> void accumulateRow(uint8_t *row, size_t n, size_t stride) {
+            using En = Endian<Little>;
+            size_t i = stride;
+#if GEOTIV_HAS_SSE2
+            if constexpr (Little == kHostLittle) {
+                constexpr size_t lanes = 16 / sizeof(U);
+                if (stride == 1 && n > lanes) {
+                    U carry = En::template load<U>(row);
+                    for (; i + lanes <= n; i += lanes) {
+                        uint8_t *p = row + i * sizeof(U);
+                        __m128i x = prefixLanes<U>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+                        x = addLanes<U>(x, splat<U>(carry));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x);
+                        carry = En::template load<U>(p + (lanes - 1) * sizeof(U));
+                    }
+                }
+            }
+#endif
+            for (; i < n; ++i) {
+                U v = En::template load<U>(row + i * sizeof(U));
+                U left = En::template load<U>(row + (i - stride) * sizeof(U));
+                En::store(row + i * sizeof(U), U(v + left));
+            }
+        }
+
+        // ------------------------------------------------------------------
+        // Predictor 3: floating point. Each row's samples are split into byte planes, most significant byte
+        // first, and the planes are differenced byte by byte with the same stride
+        // ------------------------------------------------------------------
+        /// Encode one row of n samples of B bytes stored in byte order Little
+        template <bool Little> void floatDifferenceRow(uint8_t *row, size_t n, size_t B, size_t stride,
+                                                       std::vector<uint8_t> &scratch) {
+            scratch.assign(row, row + n * B);
+            for (size_t b = 0; b < B; ++b) {
+                size_t from = Little ? B - 1 - b : b;
+                uint8_t *plane = row + b * n;
+                for (size_t i = 0; i < n; ++i)
+                    plane[i] = scratch[i * B + from];
+            }
+            differenceRow<true, uint8_t>(row, n * B, stride);
+        }
+
+        /// Decode one row of n samples of B bytes back into byte order Little
+        template <bool Little> void floatAccumulateRow(uint8_t *row, size_t n, size_t B, size_t stride,
+                                                       std::vector<uint8_t> &scratch) {
+            accumulateRow<true, uint8_t>(row, n * B, stride);
+            scratch.assign(row, row + n * B);
+            for (size_t b = 0; b < B; ++b) {
+                size_t to = Little ? B - 1 - b : b;
+                const uint8_t *plane = scratch.data() + b * n;
+                for (size_t i = 0; i < n; ++i)
+                    row[i * B + to] = plane[i];
+            }
+        }
+
+        /// Call fn(U{}) with U the unsigned integer type of B-byte samples
+        template <typename Fn> void withWordSize(size_t B, Fn &&fn) {
+            switch (B) {
+            case 1: return fn(uint8_t{});
+            case 2: return fn(uint16_t{});
+            case 4: return fn(uint32_t{});
+            case 8: return fn(uint64_t{});
+            }
+            throw std::runtime_error("Predictor on " + std::to_string(B * 8) + "-bit samples");
+        }
+
+        /// Apply predictor p to a block of `rows` rows of rowSamples samples of B bytes in byte order Little,
+        /// `stride` samples per pixel (the writer calls this on its little-endian blocks before encoding)
+        template <bool Little>
+        void applyPredictor(Predictor p, uint8_t *block, size_t rows, size_t rowSamples, size_t stride, size_t B) {
+            size_t rowBytes = rowSamples * B;
+            if (p == Predictor::Horizontal) {
+                withWordSize(B, [&](auto word) {
+                    using U = decltype(word);
+                    for (size_t r = 0; r < rows; ++r)
+                        differenceRow<Little, U>(block + r * rowBytes, rowSamples, stride);
+                });
+            } else if (p == Predictor::FloatingPoint) {
+                std::vector<uint8_t> scratch;
+                for (size_t r = 0; r < rows; ++r)
+                    floatDifferenceRow<Little>(block + r * rowBytes, rowSamples, B, stride, scratch);
+            } else if (p != Predictor::None) {
+                throw std::runtime_error("Unsupported predictor " + std::to_string(uint16_t(p)));
+            }
+        }
+
+        /// Undo applyPredictor on a decompressed block read from a file of byte order Little
+        template <bool Little>
+        void undoPredictor(Predictor p, uint8_t *block, size_t rows, size_t rowSamples, size_t stride, size_t B) {
+            size_t rowBytes = rowSamples * B;
+            if (p == Predictor::Horizontal) {
+                withWordSize(B, [&](auto word) {
+                    using U = decltype(word);
+                    for (size_t r = 0; r < rows; ++r)
+                        accumulateRow<Little, U>(block + r * rowBytes, rowSamples, stride);
+                });
+            } else if (p == Predictor::FloatingPoint) {
+                std::vector<uint8_t> scratch;
+                for (size_t r = 0; r < rows; ++r)
+                    floatAccumulateRow<Little>(block + r * rowBytes, rowSamples, B, stride, scratch);
+            } else if (p != Predictor::None) {
+                throw std::runtime_error("Unsupported predictor " + std::to_string(uint16_t(p)));
+            }
+        }
+    } // namespace detail
+} // namespace geotiv
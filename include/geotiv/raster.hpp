@@ -9,16 +9,19 @@
 
 namespace geotiv {
 
-    struct GridLayer {
-        concord::Grid<uint8_t> grid;
+    /// A named grid of a Raster; the samples and their accessors are shared with Layer (see LayerSamples)
+    struct GridLayer : LayerSamples {
         std::string name;
         std::string type;
         std::unordered_map<std::string, std::string> properties;
         std::map<uint16_t, std::vector<uint32_t>> customTags;
 
-        GridLayer(const concord::Grid<uint8_t> &g, const std::string &layer_name, const std::string &layer_type = "",
+        template <typename T>
+        GridLayer(const concord::Grid<T> &g, const std::string &layer_name, const std::string &layer_type = "",
                   const std::unordered_map<std::string, std::string> &props = {})
-            : grid(g), name(layer_name), type(layer_type), properties(props) {}
+            : name(layer_name), type(layer_type), properties(props) {
+            setGrid(g);
+        }
 
         // Helper methods for global properties stored as ASCII custom tags
         void setGlobalProperty(const std::string &key, const std::string &value) {
@@ -47,6 +50,9 @@ namespace geotiv {
 
     class Raster {
       private:
+        // Lazily read layers are decoded one by one as they are used (materialize(), gridAs<T>(), the non-const
+        // getGrid()) or all at once by load(); const access never decodes, so a const Raster can be shared
+        // between threads
         std::vector<GridLayer> grid_layers_;
         concord::Datum datum_;
         concord::Pose shift_;
@@ -58,8 +64,10 @@ namespace geotiv {
                double resolution = 1.0)
             : datum_(datum), shift_(shift), resolution_(resolution) {}
 
-        static Raster fromFile(const std::filesystem::path &path) {
-            auto rc = geotiv::ReadRasterCollection(path);
+        /// With opts.lazy only metadata is read here; each grid is decoded when first used (materialize(),
+        /// gridAs<T>() or the non-const getGrid()), or all of them by load()
+        static Raster fromFile(const std::filesystem::path &path, const ReadOptions &opts = {}) {
+            auto rc = geotiv::ReadRasterCollection(path, opts);
 
             if (rc.layers.empty()) {
                 throw std::runtime_error("Raster::fromFile: No layers found in file");
@@ -92,6 +100,9 @@ namespace geotiv {
                 props["samples_per_pixel"] = std::to_string(layer.samplesPerPixel);
 
                 GridLayer gridLayer(layer.grid, layerName, layerType, props);
+                gridLayer.sampleType = layer.sampleType;
+                gridLayer.samples = layer.samples;
+                gridLayer.gridLoader = layer.gridLoader;
 
                 // Transfer custom tags (including global properties)
                 gridLayer.customTags = layer.customTags;
@@ -111,9 +122,15 @@ namespace geotiv {
 
             for (const auto &gridLayer : grid_layers_) {
                 Layer layer;
-                layer.grid = gridLayer.grid;
-                layer.width = static_cast<uint32_t>(gridLayer.grid.cols());
-                layer.height = static_cast<uint32_t>(gridLayer.grid.rows());
+                auto take = [&](auto const &g) {
+                    layer.setGrid(g);
+                    layer.width = static_cast<uint32_t>(g.cols());
+                    layer.height = static_cast<uint32_t>(g.rows());
+                };
+                if (gridLayer.isMaterialized())
+                    gridLayer.visitGrid(take);
+                else
+                    std::visit(take, gridLayer.gridLoader()); // decode a temporary copy, the raster stays as is
                 layer.resolution = resolution_;
                 layer.datum = datum_;
                 layer.shift = shift_;
@@ -133,10 +150,23 @@ namespace geotiv {
             geotiv::WriteRasterCollection(rc, path);
         }
 
+        /// Decode every layer still deferred by a lazy fromFile()
+        void load() {
+            for (auto &layer : grid_layers_)
+                layer.materialize();
+        }
+
+        /// Whether every layer is decoded
+        bool isLoaded() const {
+            return std::all_of(grid_layers_.begin(), grid_layers_.end(),
+                               [](const GridLayer &layer) { return layer.isMaterialized(); });
+        }
+
         size_t gridCount() const { return grid_layers_.size(); }
         bool hasGrids() const { return !grid_layers_.empty(); }
         void clearGrids() { grid_layers_.clear(); }
 
+        /// Const getters never decode: a layer still deferred comes back as is (see GridLayer::isMaterialized())
         const GridLayer &getGrid(size_t index) const {
             if (index >= grid_layers_.size()) {
                 throw std::out_of_range("Grid index out of range");
@@ -148,6 +178,7 @@ namespace geotiv {
             if (index >= grid_layers_.size()) {
                 throw std::out_of_range("Grid index out of range");
             }
+            grid_layers_[index].materialize();
             return grid_layers_[index];
         }
 
@@ -166,13 +197,21 @@ namespace geotiv {
             if (it == grid_layers_.end()) {
                 throw std::runtime_error("Grid with name '" + name + "' not found");
             }
+            it->materialize();
             return *it;
         }
 
+        void addGrid(uint32_t width, uint32_t height, const std::string &name, const std::string &type = "",
+                     const std::unordered_map<std::string, std::string> &properties = {}) {
+            addGrid<uint8_t>(width, height, name, type, properties);
+        }
+
+        /// Add a grid of samples of type T (e.g. addGrid<float>(...) for elevation in meters)
+        template <typename T>
         void addGrid(uint32_t width, uint32_t height, const std::string &name, const std::string &type = "",
                      const std::unordered_map<std::string, std::string> &properties = {}) {
             // Use the shift_ directly - it's already in ENU space
-            concord::Grid<uint8_t> grid(height, width, resolution_, true, shift_);
+            concord::Grid<T> grid(height, width, resolution_, true, shift_);
             auto props = properties;
             if (!type.empty()) {
                 props["type"] = type;
@@ -275,6 +314,8 @@ namespace geotiv {
             }
         }
 
+        // Iteration hands out layers as they are, deferred ones included, so a loop decodes only the layers it
+        // calls materialize() or gridAs<T>() on
         auto begin() { return grid_layers_.begin(); }
         auto end() { return grid_layers_.end(); }
         auto begin() const { return grid_layers_.begin(); }
@@ -0,0 +1,15 @@
+#pragma once
+
+// Row kernels use SSE2 (always there on x86-64) and AVX2 when the build targets it; other CPUs get the scalar loops
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GEOTIV_HAS_SSE2 1
+#else
+#define GEOTIV_HAS_SSE2 0
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GEOTIV_HAS_AVX2 1
+#else
+#define GEOTIV_HAS_AVX2 0
+#endif
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring> // for std::memcpy
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GEOTIV_HAS_MMAP 1
+#define GEOTIV_HAS_PREAD 1
+#else
+#define GEOTIV_HAS_MMAP 0
+#define GEOTIV_HAS_PREAD 0
+#endif
+
+#include "geotiv/uring.hpp"
+
+namespace geotiv {
+    namespace fs = std::filesystem;
+
+    /// How the parser pulls bytes out of the file.
+    /// - Stream: std::ifstream seek+read per field (portable default); concurrent reads take turns
+    /// - Mmap:   map the whole file once and copy fields straight out of the mapping
+    ///           (falls back to Stream on platforms without mmap)
+    /// - Pread:  positioned pread() calls on one descriptor, so decoding threads never share a cursor
+    ///           (falls back to Stream on platforms without pread)
+    /// - IoUring: Pread, but the strips or tiles a read needs are submitted to io_uring in batches and decoded as
+    ///            they complete, keeping many reads in flight (falls back to Pread without io_uring)
+    enum class ReadBackend { Stream, Mmap, Pread, IoUring };
+
+    /// Expected access pattern, forwarded to the kernel as an madvise() hint for Mmap.
+    enum class AccessPattern { Normal, Sequential, Random };
+
+    struct ReadOptions {
+        ReadBackend backend = ReadBackend::Stream;
+        AccessPattern access = AccessPattern::Sequential;
+        /// Parse metadata only and keep the file open; each layer's grid is decoded on first materialize()
+        bool lazy = false;
+        /// Threads decoding the strips or tiles of a layer; 0 = one per hardware thread.
+        /// Use with Mmap or Pread for reads that scale, Stream serializes the I/O part.
+        unsigned threads = 1;
+        /// Target ground resolution in meters per pixel (0 = full resolution). Layers with overviews are read from
+        /// their coarsest level that is still at least this fine; only that level's strips or tiles are decoded.
+        double targetResolution = 0;
+    };
+
+    // ------------------------------------------------------------------
+    // Positioned byte sources the parser reads from
+    // ------------------------------------------------------------------
+    /// Random-access bytes of a TIFF. read() may be called from several decoding threads at once
+    /// (ReadOptions::threads > 1), so implementations must not keep a shared cursor.
+    class ByteSource {
+      public:
+        virtual ~ByteSource() = default;
+
+        /// Copy up to n bytes starting at offset into dst, returns the number of bytes copied.
+        virtual size_t read(uint64_t offset, void *dst, size_t n) = 0;
+        virtual uint64_t size() const = 0;
+        /// All size() bytes when they sit in memory, so compressed blocks are decoded in place; else nullptr.
+        virtual const uint8_t *data() const { return nullptr; }
+
+        /// Read every request, calling done(i, bytesRead) on the calling thread as request i completes, in any
+        /// order. Sources that can keep several reads in flight override this; by default it is read() in a loop.
+        virtual void readBatch(std::span<const ReadRequest> requests, const std::function<void(size_t, size_t)> &done) {
+            for (size_t i = 0; i < requests.size(); ++i)
+                done(i, read(requests[i].offset, requests[i].dst, requests[i].n));
+        }
+    };
+
+    /// Bytes already in memory. Nothing is copied up front: the span must outlive the source and every lazy layer
+    /// read from it.
+    class SpanSource : public ByteSource {
+        std::span<const uint8_t> bytes_;
+
+      public:
+        explicit SpanSource(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+        size_t read(uint64_t offset, void *dst, size_t n) override {
+            if (offset >= bytes_.size())
+                return 0;
+            n = static_cast<size_t>(std::min<uint64_t>(n, bytes_.size() - offset));
+            std::memcpy(dst, bytes_.data() + offset, n);
+            return n;
+        }
+
+        uint64_t size() const override { return bytes_.size(); }
+        const uint8_t *data() const override { return bytes_.data(); }
+    };
+
+    /// Bytes fetched by a user callback with the semantics of ByteSource::read (shared memory, object stores, ...)
+    class CallbackSource : public ByteSource {
+      public:
+        using ReadFn = std::function<size_t(uint64_t offset, void *dst, size_t n)>;
+
+        CallbackSource(uint64_t size, ReadFn read) : size_(size), read_(std::move(read)) {
+            if (!read_)
+                throw std::invalid_argument("CallbackSource: empty read callback");
+        }
+
+        size_t read(uint64_t offset, void *dst, size_t n) override {
+            if (offset >= size_)
+                return 0;
+            return read_(offset, dst, static_cast<size_t>(std::min<uint64_t>(n, size_ - offset)));
+        }
+
+        uint64_t size() const override { return size_; }
+
+      private:
+        uint64_t size_;
+        ReadFn read_;
+    };
+
+    namespace detail {
+        using Source = ByteSource;
+
+        class StreamSource : public Source {
+            std::ifstream f_;
+            uint64_t size_ = 0;
+            std::mutex mutex_; // lazy layers may share one stream across threads
+
+          public:
+            explicit StreamSource(const fs::path &file) : f_(file, std::ios::binary) {
+                if (!f_)
+                    throw std::runtime_error("Cannot open \"" + file.string() + "\"");
+                f_.seekg(0, std::ios::end);
+                size_ = static_cast<uint64_t>(f_.tellg());
+                f_.seekg(0, std::ios::beg);
+            }
+
+            size_t read(uint64_t offset, void *dst, size_t n) override {
+                std::lock_guard<std::mutex> lock(mutex_);
+                f_.clear();
+                f_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+                f_.read(reinterpret_cast<char *>(dst), static_cast<std::streamsize>(n));
+                return static_cast<size_t>(f_.gcount());
+            }
+
+            uint64_t size() const override { return size_; }
+        };
+
+#if GEOTIV_HAS_MMAP
+        class MappedSource : public Source {
+            const uint8_t *data_ = nullptr;
+            uint64_t size_ = 0;
+
+          public:
+            MappedSource(const fs::path &file, AccessPattern access) {
+                int fd = ::open(file.c_str(), O_RDONLY);
+                if (fd < 0)
+                    throw std::runtime_error("Cannot open \"" + file.string() + "\"");
+                struct stat st;
+                if (::fstat(fd, &st) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("Cannot stat \"" + file.string() + "\"");
+                }
+                size_ = static_cast<uint64_t>(st.st_size);
+                if (size_ > 0) {
+                    void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p == MAP_FAILED) {
+                        ::close(fd);
+                        throw std::runtime_error("Cannot mmap \"" + file.string() + "\"");
+                    }
+                    data_ = static_cast<const uint8_t *>(p);
+
+                    int advice = MADV_NORMAL;
+                    if (access == AccessPattern::Sequential)
+                        advice = MADV_SEQUENTIAL;
+                    else if (access == AccessPattern::Random)
+                        advice = MADV_RANDOM;
+                    ::madvise(const_cast<uint8_t *>(data_), size_, advice); // hint only, failure is harmless
+                }
+                ::close(fd); // the mapping keeps its own reference to the file
+            }
+
+            ~MappedSource() override {
+                if (data_)
+                    ::munmap(const_cast<uint8_t *>(data_), size_);
+            }
+
+            MappedSource(const MappedSource &) = delete;
+            MappedSource &operator=(const MappedSource &) = delete;
+
+            size_t read(uint64_t offset, void *dst, size_t n) override {
+                if (offset >= size_)
+                    return 0;
+                n = static_cast<size_t>(std::min<uint64_t>(n, size_ - offset));
+                std::memcpy(dst, data_ + offset, n);
+                return n;
+            }
+
+            uint64_t size() const override { return size_; }
+            const uint8_t *data() const override { return data_; }
+        };
+#endif
+
+#if GEOTIV_HAS_PREAD
+        class PreadSource : public Source {
+            int fd_ = -1;
+            uint64_t size_ = 0;
+
+          public:
+            explicit PreadSource(const fs::path &file) {
+                fd_ = ::open(file.c_str(), O_RDONLY);
+                if (fd_ < 0)
+                    throw std::runtime_error("Cannot open \"" + file.string() + "\"");
+                struct stat st;
+                if (::fstat(fd_, &st) != 0) {
+                    ::close(fd_);
+                    throw std::runtime_error("Cannot stat \"" + file.string() + "\"");
+                }
+                size_ = static_cast<uint64_t>(st.st_size);
+            }
+
+            ~PreadSource() override { ::close(fd_); }
+
+            PreadSource(const PreadSource &) = delete;
+            PreadSource &operator=(const PreadSource &) = delete;
+
+            int fd() const { return fd_; }
+
+            size_t read(uint64_t offset, void *dst, size_t n) override {
+                size_t got = 0;
+                while (got < n) {
+                    ssize_t r = ::pread(fd_, static_cast<uint8_t *>(dst) + got, n - got, static_cast<off_t>(offset + got));
+                    if (r < 0 && errno == EINTR)
+                        continue;
+                    if (r <= 0)
+                        break;
+                    got += size_t(r);
+                }
+                return got;
+            }
+
+            uint64_t size() const override { return size_; }
+        };
+#endif
+
+#if GEOTIV_HAS_IO_URING && GEOTIV_HAS_PREAD
+        /// PreadSource whose batches go through io_uring. A ring serves one batch at a time, so concurrent
+        /// batches (one per decoding thread) each take a ring from a pool that grows to the number of threads.
+        /// When the kernel refuses io_uring, batches are plain preads.
+        class IoUringSource : public PreadSource {
+            static constexpr unsigned kDepth = 64;
+            std::mutex mutex_;
+            std::vector<std::unique_ptr<IoRing>> idle_;
+            bool available_ = false;
+
+            std::unique_ptr<IoRing> acquire() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!idle_.empty()) {
+                        auto ring = std::move(idle_.back());
+                        idle_.pop_back();
+                        return ring;
+                    }
+                }
+                auto ring = std::make_unique<IoRing>(kDepth);
+                return ring->ok() ? std::move(ring) : nullptr;
+            }
+
+          public:
+            explicit IoUringSource(const fs::path &file) : PreadSource(file) {
+                if (auto ring = acquire()) {
+                    available_ = true;
+                    idle_.push_back(std::move(ring));
+                }
+            }
+
+            /// Whether batches really go through io_uring
+            bool usesRing() const { return available_; }
+
+            void readBatch(std::span<const ReadRequest> requests,
+                           const std::function<void(size_t, size_t)> &done) override {
+                std::unique_ptr<IoRing> ring = available_ && requests.size() > 1 ? acquire() : nullptr;
+                if (!ring)
+                    return PreadSource::readBatch(requests, done);
+                ring->readAll(fd(), requests, done); // a ring that threw is dropped, not pooled
+                if (!ring->ok())
+                    return; // io_uring_enter failed and the batch went through pread; so does a failed ring
+                std::lock_guard<std::mutex> lock(mutex_);
+                idle_.push_back(std::move(ring));
+            }
+        };
+#endif
+
+        inline std::unique_ptr<Source> openSource(const fs::path &file, const ReadOptions &opts) {
+#if GEOTIV_HAS_MMAP
+            if (opts.backend == ReadBackend::Mmap)
+                return std::make_unique<MappedSource>(file, opts.access);
+#endif
+#if GEOTIV_HAS_IO_URING && GEOTIV_HAS_PREAD
+            if (opts.backend == ReadBackend::IoUring)
+                return std::make_unique<IoUringSource>(file);
+#endif
+#if GEOTIV_HAS_PREAD
+            if (opts.backend == ReadBackend::Pread || opts.backend == ReadBackend::IoUring)
+                return std::make_unique<PreadSource>(file);
+#endif
+            return std::make_unique<StreamSource>(file);
+        }
+
+        // ------------------------------------------------------------------
+        // Sequential cursor over a Source (mimics the old seekg/read pairs)
+        // ------------------------------------------------------------------
+        class Cursor {
+            Source &src_;
+            uint64_t pos_ = 0;
+
+          public:
+            explicit Cursor(Source &src) : src_(src) {}
+
+            Source &source() const { return src_; }
+
+            void seek(uint64_t offset) { pos_ = offset; }
+            uint64_t tell() const { return pos_; }
+
+            /// Read n bytes at the current position and advance, returns the number of bytes read.
+            size_t read(void *dst, size_t n) {
+                size_t got = src_.read(pos_, dst, n);
+                pos_ += got;
+                return got;
+            }
+        };
+    } // namespace detail
+
+    /// The file as a ByteSource, opened with opts.backend and opts.access
+    inline std::shared_ptr<ByteSource> openByteSource(const fs::path &file, const ReadOptions &opts = {}) {
+        return detail::openSource(file, opts);
+    }
+
+} // namespace geotiv
@@ -3,8 +3,11 @@
 #include <filesystem>
 #include <functional>
 #include <map>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
 #include "concord/concord.hpp"
@@ -55,19 +58,180 @@ namespace geotiv {
 
     // All coordinate systems are now WGS84 by default
 
-    struct Layer {
+    /// Numeric type of a layer's samples, stored in TIFF as BitsPerSample (258) + SampleFormat (339).
+    /// The order matches the alternatives of SampleGrid.
+    enum class SampleType { UInt8, Int8, UInt16, Int16, UInt32, Int32, Float32, Float64 };
+
+    /// A grid of any supported sample type; index() is the SampleType of the held grid
+    using SampleGrid = std::variant<concord::Grid<uint8_t>, concord::Grid<int8_t>, concord::Grid<uint16_t>,
+                                    concord::Grid<int16_t>, concord::Grid<uint32_t>, concord::Grid<int32_t>,
+                                    concord::Grid<float>, concord::Grid<double>>;
+
+    /// SampleType of the C++ sample type T
+    template <typename T> constexpr SampleType sampleTypeOf() {
+        if constexpr (std::is_same_v<T, uint8_t>)
+            return SampleType::UInt8;
+        else if constexpr (std::is_same_v<T, int8_t>)
+            return SampleType::Int8;
+        else if constexpr (std::is_same_v<T, uint16_t>)
+            return SampleType::UInt16;
+        else if constexpr (std::is_same_v<T, int16_t>)
+            return SampleType::Int16;
+        else if constexpr (std::is_same_v<T, uint32_t>)
+            return SampleType::UInt32;
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return SampleType::Int32;
+        else if constexpr (std::is_same_v<T, float>)
+            return SampleType::Float32;
+        else if constexpr (std::is_same_v<T, double>)
+            return SampleType::Float64;
+        else
+            static_assert(sizeof(T) == 0, "unsupported sample type");
+    }
+
+    template <typename T> constexpr SampleType sampleTypeOf(concord::Grid<T> const &) { return sampleTypeOf<T>(); }
+
+    /// Bytes per sample
+    inline size_t sampleBytes(SampleType t) {
+        static constexpr size_t bytes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+        return bytes[size_t(t)];
+    }
+
+    /// SampleFormat tag value: 1 = unsigned integer, 2 = signed integer, 3 = IEEE floating point
+    inline uint16_t sampleFormat(SampleType t) {
+        static constexpr uint16_t formats[] = {1, 2, 1, 2, 1, 2, 3, 3};
+        return formats[size_t(t)];
+    }
+
+    /// SampleType from BitsPerSample and SampleFormat; throws for combinations the library cannot hold
+    inline SampleType sampleTypeFromTiff(uint32_t bits, uint32_t format) {
+        for (size_t i = 0; i < std::variant_size_v<SampleGrid>; ++i) {
+            auto t = SampleType(i);
+            if (sampleBytes(t) * 8 == bits && sampleFormat(t) == format)
+                return t;
+        }
+        throw std::runtime_error("Unsupported samples: " + std::to_string(bits) + "-bit with SampleFormat " +
+                                 std::to_string(format));
+    }
+
+    /// Call fn(std::type_identity<T>{}) for the C++ type of t, so the body is compiled once per sample type
+    /// and the type is dispatched once per call rather than per sample.
+    template <typename Fn> decltype(auto) withSampleType(SampleType t, Fn &&fn) {
+        switch (t) {
+        case SampleType::UInt8: return fn(std::type_identity<uint8_t>{});
+        case SampleType::Int8: return fn(std::type_identity<int8_t>{});
+        case SampleType::UInt16: return fn(std::type_identity<uint16_t>{});
+        case SampleType::Int16: return fn(std::type_identity<int16_t>{});
+        case SampleType::UInt32: return fn(std::type_identity<uint32_t>{});
+        case SampleType::Int32: return fn(std::type_identity<int32_t>{});
+        case SampleType::Float32: return fn(std::type_identity<float>{});
+        case SampleType::Float64: return fn(std::type_identity<double>{});
+        }
+        throw std::runtime_error("Unknown sample type");
+    }
+
+    /// TIFF Compression tag (259) values. Each strip or tile is compressed on its own.
+    enum class Compression : uint16_t { None = 1, LZW = 5, Deflate = 8, PackBits = 32773 };
+
+    /// TIFF Predictor tag (317) values: rows are differenced before compression so smooth data packs tighter.
+    /// Horizontal suits integer samples, FloatingPoint (byte planes, then differences) suits float samples.
+    enum class Predictor : uint16_t { None = 1, Horizontal = 2, FloatingPoint = 3 };
+
+    /// How the writer reduces each 2x2 block when building overview levels (WriteOptions::overviewLevels):
+    /// Mean for imagery and elevation, Max for occlusion/cost layers, Mode (most frequent value) for class layers.
+    enum class Resampling { Mean, Max, Mode };
+
+    /// The samples of a layer, geo-gridded, with the accessors Layer and GridLayer share: 8-bit samples live in
+    /// `grid`, every other type in `samples`. A lazily read layer holds a gridLoader instead until materialize().
+    struct LayerSamples {
+        SampleType sampleType = SampleType::UInt8;
+        concord::Grid<uint8_t> grid;
+        SampleGrid samples;
+
+        // Lazy mode (ReadOptions::lazy): decodes the samples from the still-open file on first materialize()
+        std::function<SampleGrid()> gridLoader;
+
+        /// Decode the samples if they are still deferred, then return the 8-bit grid (empty for other types)
+        concord::Grid<uint8_t> &materialize() {
+            if (gridLoader) {
+                setSamples(gridLoader());
+                gridLoader = nullptr;
+            }
+            return grid;
+        }
+
+        /// Decoded samples as Grid<T>; throws unless T matches sampleType
+        template <typename T> concord::Grid<T> &gridAs() {
+            materialize();
+            if (sampleType != sampleTypeOf<T>())
+                throw std::runtime_error("gridAs(): requested type does not match the layer's samples");
+            if constexpr (std::is_same_v<T, uint8_t>)
+                return grid;
+            else
+                return std::get<concord::Grid<T>>(samples);
+        }
+
+        /// As above, without decoding: throws for a layer still deferred
+        template <typename T> const concord::Grid<T> &gridAs() const {
+            if (!isMaterialized())
+                throw std::runtime_error("gridAs(): the layer is not decoded yet; call materialize() first");
+            if (sampleType != sampleTypeOf<T>())
+                throw std::runtime_error("gridAs(): requested type does not match the layer's samples");
+            if constexpr (std::is_same_v<T, uint8_t>)
+                return grid;
+            else
+                return std::get<concord::Grid<T>>(samples);
+        }
+
+        /// Replace the samples; sampleType follows T
+        template <typename T> void setGrid(concord::Grid<T> g) {
+            sampleType = sampleTypeOf<T>();
+            if constexpr (std::is_same_v<T, uint8_t>) {
+                grid = std::move(g);
+                samples = SampleGrid{};
+            } else {
+                grid = concord::Grid<uint8_t>{};
+                samples = std::move(g);
+            }
+        }
+
+        void setSamples(SampleGrid g) {
+            std::visit([this](auto &typed) { setGrid(std::move(typed)); }, g);
+        }
+
+        /// Call fn with the decoded grid of the layer's sample type
+        template <typename Fn> decltype(auto) visitGrid(Fn &&fn) const {
+            if (sampleType == SampleType::UInt8)
+                return fn(grid);
+            return std::visit(fn, samples);
+        }
+
+        bool isMaterialized() const { return !gridLoader; }
+    };
+
+    struct Layer : LayerSamples {
         // **New**: where in the file this IFD lived
-        uint32_t ifdOffset = 0;
+        uint64_t ifdOffset = 0; // 64-bit so BigTIFF offsets fit
+        uint32_t subfileType = 0; // NewSubfileType (254); bit 0 marks a reduced-resolution overview
 
         // dims & layout
         uint32_t width = 0;
         uint32_t height = 0;
         uint32_t samplesPerPixel = 0;
         uint32_t planarConfig = 0;
+        Compression compression = Compression::None; // codec of the strips/tiles, as read or to be written
+        Predictor predictor = Predictor::None;       // applied under LZW or Deflate, as read or to be written
 
         // strip info
-        std::vector<uint32_t> stripOffsets;
-        std::vector<uint32_t> stripByteCounts;
+        uint32_t rowsPerStrip = 0;
+        std::vector<uint64_t> stripOffsets;
+        std::vector<uint64_t> stripByteCounts;
+
+        // tile info (tiled TIFFs only; tileWidth == 0 means the layer is stored in strips)
+        uint32_t tileWidth = 0;
+        uint32_t tileLength = 0;
+        std::vector<uint64_t> tileOffsets;
+        std::vector<uint64_t> tileByteCounts;
 
         // Per-IFD geospatial metadata (always WGS84)
         concord::Datum datum;    // lat=lon=alt=0 (for coordinate transformations)
@@ -78,8 +242,12 @@ namespace geotiv {
         std::string imageDescription;
         std::map<uint16_t, std::vector<uint32_t>> customTags; // For additional TIFF tags
 
-        // the actual samples, geo-gridded
-        concord::Grid<uint8_t> grid;
+        // Overviews: reduced-resolution IFDs that follow this layer in the file, largest first, as metadata
+        // (their grids stay empty). The writer builds new ones with overviewResampling instead of copying these.
+        std::vector<Layer> overviews;
+        Resampling overviewResampling = Resampling::Mean;
+
+        bool isTiled() const { return tileWidth != 0; }
         
         // Helper methods for global properties stored as ASCII custom tags
         void setGlobalProperty(const std::string& key, const std::string& value) {
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <span>
+#include <vector>
+
+// io_uring is driven through its raw system calls, so there is nothing to link. Linux builds with the kernel
+// header get it by default; define GEOTIV_HAS_IO_URING=0 to leave it out.
+#ifndef GEOTIV_HAS_IO_URING
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define GEOTIV_HAS_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef GEOTIV_HAS_IO_URING
+#define GEOTIV_HAS_IO_URING 0
+#endif
+#if GEOTIV_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace geotiv {
+    /// One positioned read of a batch: n bytes at offset into dst
+    struct ReadRequest {
+        uint64_t offset = 0;
+        void *dst = nullptr;
+        size_t n = 0;
+    };
+
+    namespace detail {
+#if GEOTIV_HAS_IO_URING
+        /// Read n bytes at offset from fd with pread, retrying short reads; returns the bytes read
+        inline size_t preadFully(int fd, uint64_t offset, void *dst, size_t n) {
+            size_t got = 0;
+            while (got < n) {
+                ssize_t r = ::pread(fd, static_cast<uint8_t *>(dst) + got, n - got, static_cast<off_t>(offset + got));
+                if (r < 0 && errno == EINTR)
+                    continue;
+                if (r <= 0)
+                    break;
+                got += size_t(r);
+            }
+            return got;
+        }
+
+        // ------------------------------------------------------------------
+        // A single-threaded io_uring instance: submission and completion rings mapped from the kernel
+        // ------------------------------------------------------------------
+        class IoRing {
+            int fd_ = -1;
+            bool failed_ = false;
+            unsigned entries_ = 0;
+            void *sqRing_ = MAP_FAILED, *cqRing_ = MAP_FAILED, *sqes_ = MAP_FAILED;
+            size_t sqRingBytes_ = 0, cqRingBytes_ = 0, sqesBytes_ = 0;
+            unsigned *sqHead_ = nullptr, *sqTail_ = nullptr, *sqMask_ = nullptr, *sqArray_ = nullptr;
+            unsigned *cqHead_ = nullptr, *cqTail_ = nullptr, *cqMask_ = nullptr;
+            io_uring_cqe *cqes_ = nullptr;
+
+            static unsigned *at(void *base, uint32_t offset) {
+                return reinterpret_cast<unsigned *>(static_cast<uint8_t *>(base) + offset);
+            }
+
+            void release() {
+                if (sqes_ != MAP_FAILED)
+                    ::munmap(sqes_, sqesBytes_);
+                if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+                    ::munmap(cqRing_, cqRingBytes_);
+                if (sqRing_ != MAP_FAILED)
+                    ::munmap(sqRing_, sqRingBytes_);
+                if (fd_ >= 0)
+                    ::close(fd_);
+                fd_ = -1;
+            }
+
+          protected:
+            /// io_uring_enter: submit `submit` queued reads and wait for `wait` completions; -errno on failure.
+            /// Virtual so tests can make it fail.
+            virtual int enter(unsigned submit, unsigned wait) {
+                long r = ::syscall(__NR_io_uring_enter, fd_, submit, wait, wait ? IORING_ENTER_GETEVENTS : 0u,
+                                   nullptr, 0);
+                return r < 0 ? -errno : int(r);
+            }
+
+          public:
+            /// Set up a ring of `depth` entries; ok() is false when the kernel refuses (too old, or disabled)
+            explicit IoRing(unsigned depth) {
+                io_uring_params p;
+                std::memset(&p, 0, sizeof(p));
+                long fd = ::syscall(__NR_io_uring_setup, depth, &p);
+                if (fd < 0)
+                    return;
+                fd_ = int(fd);
+                entries_ = p.sq_entries;
+
+                sqRingBytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+                cqRingBytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+                bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+                if (single)
+                    sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+                sqRing_ = ::mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                 IORING_OFF_SQ_RING);
+                cqRing_ = single ? sqRing_
+                                 : ::mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                          fd_, IORING_OFF_CQ_RING);
+                sqesBytes_ = p.sq_entries * sizeof(io_uring_sqe);
+                sqes_ = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                               IORING_OFF_SQES);
+                if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+                    release();
+                    return;
+                }
+
+                sqHead_ = at(sqRing_, p.sq_off.head);
+                sqTail_ = at(sqRing_, p.sq_off.tail);
+                sqMask_ = at(sqRing_, p.sq_off.ring_mask);
+                sqArray_ = at(sqRing_, p.sq_off.array);
+                cqHead_ = at(cqRing_, p.cq_off.head);
+                cqTail_ = at(cqRing_, p.cq_off.tail);
+                cqMask_ = at(cqRing_, p.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<io_uring_cqe *>(static_cast<uint8_t *>(cqRing_) + p.cq_off.cqes);
+            }
+
+            virtual ~IoRing() { release(); }
+
+            IoRing(const IoRing &) = delete;
+            IoRing &operator=(const IoRing &) = delete;
+
+            /// False when the kernel refused the ring, or once io_uring_enter failed and readAll fell back to pread
+            bool ok() const { return fd_ >= 0 && !failed_; }
+
+            /// Read every request from file descriptor fd with at most a ring's worth of reads in flight, calling
+            /// done(i, bytesRead) on this thread as each one completes. Short or failed reads are finished with
+            /// pread, so bytesRead is only short at the end of the file. If done throws, the reads still in
+            /// flight are drained before the exception propagates, since they write into the caller's buffers.
+            /// If io_uring_enter itself fails, the reads the kernel took are drained the same way, the rest are
+            /// read with pread, and the ring is no longer ok().
+            void readAll(int fd, std::span<const ReadRequest> requests,
+                         const std::function<void(size_t, size_t)> &done) {
+                size_t next = 0, inFlight = 0;
+                unsigned unsubmitted = 0;
+                std::exception_ptr error;
+                auto finish = [&](size_t i, size_t got) {
+                    const ReadRequest &rq = requests[i];
+                    if (got < rq.n) // interrupted, short, or an op this kernel lacks: finish synchronously
+                        got += preadFully(fd, rq.offset + got, static_cast<uint8_t *>(rq.dst) + got, rq.n - got);
+                    try {
+                        done(i, got);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                };
+                auto reap = [&]() {
+                    unsigned head = *cqHead_;
+                    unsigned cqTail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+                    for (; head != cqTail; ++head) {
+                        const io_uring_cqe &cqe = cqes_[head & *cqMask_];
+                        --inFlight;
+                        if (!error)
+                            finish(size_t(cqe.user_data), cqe.res > 0 ? size_t(cqe.res) : 0);
+                    }
+                    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+                };
+
+                while (next < requests.size() || inFlight > 0) {
+                    // Queue reads until the ring is full; reads over 1 GiB go around it with pread
+                    unsigned tail = *sqTail_;
+                    while (next < requests.size() && inFlight < entries_ && !error) {
+                        const ReadRequest &rq = requests[next];
+                        if (rq.n > (size_t(1) << 30)) {
+                            finish(next++, 0);
+                            continue;
+                        }
+                        unsigned idx = tail & *sqMask_;
+                        io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + idx;
+                        std::memset(sqe, 0, sizeof(*sqe));
+                        sqe->opcode = IORING_OP_READ;
+                        sqe->fd = fd;
+                        sqe->off = rq.offset;
+                        sqe->addr = reinterpret_cast<uint64_t>(rq.dst);
+                        sqe->len = static_cast<uint32_t>(rq.n);
+                        sqe->user_data = next++;
+                        sqArray_[idx] = idx;
+                        ++tail, ++inFlight, ++unsubmitted;
+                    }
+                    __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+                    if (inFlight == 0)
+                        break;
+
+                    int r = enter(unsubmitted, 1);
+                    if (r < 0 && r != -EINTR && r != -EAGAIN && r != -EBUSY) {
+                        // Take back the reads the kernel never picked up, wait for the ones it did (their
+                        // completions still arrive in the mapped ring, even if enter keeps failing), then read
+                        // everything left with pread
+                        failed_ = true;
+                        unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+                        std::vector<size_t> retry;
+                        for (unsigned t = head; t != tail; ++t)
+                            retry.push_back(size_t(static_cast<io_uring_sqe *>(sqes_)[t & *sqMask_].user_data));
+                        __atomic_store_n(sqTail_, head, __ATOMIC_RELEASE);
+                        inFlight -= retry.size();
+                        for (reap(); inFlight > 0; reap()) {
+                            if (enter(0, 1) < 0)
+                                sched_yield();
+                        }
+                        for (size_t i : retry)
+                            if (!error)
+                                finish(i, 0);
+                        while (next < requests.size() && !error)
+                            finish(next++, 0);
+                        break;
+                    }
+                    if (r > 0)
+                        unsubmitted -= std::min<unsigned>(unsubmitted, unsigned(r));
+                    reap();
+                }
+                if (error)
+                    std::rethrow_exception(error);
+            }
+        };
+#endif
+    } // namespace detail
+} // namespace geotiv
@@ -1,380 +1,892 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring> // for std::memcpy
 #include <filesystem>
 #include <fstream>
 #include <stdexcept>
 #include <string>
+#include <utility> // for std::as_const
 #include <vector>
 
 #include "concord/concord.hpp" // Datum, Euler
-#include "geotiv/types.hpp"    // RasterCollection
+#include "geotiv/codec.hpp"
+#include "geotiv/endian.hpp"
+#include "geotiv/overview.hpp"
+#include "geotiv/parallel.hpp"
+#include "geotiv/predictor.hpp"
+#include "geotiv/types.hpp" // RasterCollection
 
 namespace geotiv {
     namespace fs = std::filesystem;
 
-    /// Write out all layers in rc as a chained‐IFD GeoTIFF.
-    /// Each IFD can have its own CRS/DATUM/HEADING/PixelScale and custom tags.
-    ///
-    /// CRS Flavor Handling:
-    /// - ENU flavor: Grid data is already in local space, datum provides reference
-    /// - WGS flavor: Grid data represents WGS coordinates, datum provides reference
-    /// The Grid object contains the appropriate coordinate system based on parsing
-    inline std::vector<uint8_t> toTiffBytes(RasterCollection const &rc) {
-        size_t N = rc.layers.size();
-        if (N == 0)
-            throw std::runtime_error("toTiffBytes(): no layers");
-
-        // --- 1) Flatten each layer's grid into its own chunky strip ---
-        std::vector<std::vector<uint8_t>> strips(N);
-        std::vector<uint32_t> stripCounts(N), stripOffsets(N);
-        for (size_t i = 0; i < N; ++i) {
-            auto const &layer = rc.layers[i];
-            auto const &g = layer.grid;
+    /// File flavour produced by the writer.
+    /// - Auto:    classic TIFF, promoted to BigTIFF when the layout no longer fits 32-bit offsets
+    /// - Classic: always classic TIFF, throws if the file would exceed 4 GiB
+    /// - BigTiff: always BigTIFF (magic 43, 64-bit offsets)
+    enum class TiffFormat { Auto, Classic, BigTiff };
+
+    struct WriteOptions {
+        /// 0 writes one strip per layer; otherwise square tiles of this size (multiple of 16, e.g. 256 or 512)
+        uint32_t tileSize = 0;
+        /// Strip height for untiled layers: rowsPerStrip rows if set, else as many rows as fit in stripBytes
+        /// (at least one, e.g. 64 * 1024), else the whole layer in one strip
+        uint32_t rowsPerStrip = 0;
+        uint64_t stripBytes = 0;
+        TiffFormat format = TiffFormat::Auto;
+        /// Threads compressing the strips/tiles of layers with Layer::compression set (0 = all hardware threads)
+        unsigned threads = 1;
+        /// Cloud-optimized layout (COG): every IFD and its tag data right after the header, then the tiles of
+        /// each layer in row-major order, smallest layer first. A range reader gets the whole directory in one
+        /// read and each tile in one more. Needs tileSize.
+        bool cloudOptimized = false;
+        /// Overview levels (2x, 4x, 8x, ...) written after each layer as reduced-resolution IFDs
+        /// (NewSubfileType = 1), built with Layer::overviewResampling on `threads` threads. Stops early once a
+        /// level fits in one tile (one pixel when writing strips).
+        uint32_t overviewLevels = 0;
+    };
+
+    namespace detail {
+        // ------------------------------------------------------------------
+        // IFD entries with their values pre-encoded as little-endian bytes
+        // ------------------------------------------------------------------
+        struct TagValue {
+            uint16_t tag = 0;
+            uint16_t type = 0; // 2 = ASCII, 3 = SHORT, 4 = LONG, 12 = DOUBLE, 16 = LONG8
+            uint64_t count = 0;
+            std::vector<uint8_t> bytes;
+        };
+
+        inline void putLE(std::vector<uint8_t> &out, uint64_t v, int nbytes) {
+            for (int i = 0; i < nbytes; ++i) {
+                out.push_back(uint8_t((v >> (8 * i)) & 0xFF));
+            }
+        }
+
+        inline TagValue shortTag(uint16_t tag, const std::vector<uint16_t> &values) {
+            TagValue t{tag, 3, values.size(), {}};
+            for (auto v : values)
+                putLE(t.bytes, v, 2);
+            return t;
+        }
+
+        inline TagValue longTag(uint16_t tag, const std::vector<uint32_t> &values) {
+            TagValue t{tag, 4, values.size(), {}};
+            for (auto v : values)
+                putLE(t.bytes, v, 4);
+            return t;
+        }
+
+        /// File offsets or byte counts: LONG in classic TIFF, LONG8 in BigTIFF
+        inline TagValue offsetTag(uint16_t tag, const std::vector<uint64_t> &values, bool bigTiff) {
+            TagValue t{tag, uint16_t(bigTiff ? 16 : 4), values.size(), {}};
+            for (auto v : values)
+                putLE(t.bytes, v, bigTiff ? 8 : 4);
+            return t;
+        }
+
+        inline TagValue doubleTag(uint16_t tag, const std::vector<double> &values) {
+            TagValue t{tag, 12, values.size(), {}};
+            for (auto d : values) {
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(d));
+                putLE(t.bytes, bits, 8);
+            }
+            return t;
+        }
+
+        inline TagValue asciiTag(uint16_t tag, const std::string &text) {
+            TagValue t{tag, 2, text.size() + 1, {}};
+            t.bytes.assign(text.begin(), text.end());
+            t.bytes.push_back('\0');
+            return t;
+        }
+
+        /// Bytes an IFD occupies on disk: directory + out-of-line values (each padded to a word boundary).
+        /// Classic entries are 12 bytes with a 4-byte value field, BigTIFF entries 20 bytes with an 8-byte one.
+        inline uint64_t ifdSize(const std::vector<TagValue> &entries, bool bigTiff) {
+            size_t fieldSize = bigTiff ? 8 : 4;
+            uint64_t size = bigTiff ? 8 + entries.size() * 20 + 8 : 2 + entries.size() * 12 + 4;
+            for (auto const &e : entries) {
+                if (e.bytes.size() > fieldSize)
+                    size += (e.bytes.size() + 1) & ~size_t(1);
+            }
+            return size;
+        }
+
+        /// Serialize an IFD that will live at offset; out-of-line values follow the directory directly.
+        /// The result is exactly ifdSize(entries, bigTiff) bytes.
+        inline std::vector<uint8_t> serializeIFD(uint64_t offset, std::vector<TagValue> entries, uint64_t nextIFD,
+                                                 bool bigTiff) {
+            std::sort(entries.begin(), entries.end(),
+                      [](TagValue const &a, TagValue const &b) { return a.tag < b.tag; });
+
+            int fieldSize = bigTiff ? 8 : 4;
+            std::vector<uint8_t> dir;
+            uint64_t dataPos = offset + (bigTiff ? 8 + entries.size() * 20 + 8 : 2 + entries.size() * 12 + 4);
+            std::vector<uint8_t> data;
+
+            putLE(dir, entries.size(), bigTiff ? 8 : 2);
+            for (auto const &e : entries) {
+                putLE(dir, e.tag, 2);
+                putLE(dir, e.type, 2);
+                putLE(dir, e.count, fieldSize);
+                if (e.bytes.size() <= size_t(fieldSize)) {
+                    // Value fits in the offset field, left-justified
+                    std::vector<uint8_t> inl(e.bytes);
+                    inl.resize(fieldSize, 0);
+                    dir.insert(dir.end(), inl.begin(), inl.end());
+                } else {
+                    putLE(dir, dataPos + data.size(), fieldSize);
+                    data.insert(data.end(), e.bytes.begin(), e.bytes.end());
+                    if (data.size() % 2)
+                        data.push_back(0);
+                }
+            }
+            putLE(dir, nextIFD, fieldSize);
+
+            dir.insert(dir.end(), data.begin(), data.end());
+            return dir;
+        }
+
+        // ------------------------------------------------------------------
+        // Pixel layout: one strip per layer, or square tiles
+        // ------------------------------------------------------------------
+        /// Pixel bytes are handed to the sink in chunks of at most this size (or one tile)
+        constexpr size_t kWriteChunkBytes = size_t(1) << 20;
+
+        /// RowsPerStrip of an untiled W x H layer with pixelBytes bytes per pixel (samples x bytes per sample)
+        inline uint32_t stripRows(uint32_t W, uint32_t H, uint32_t pixelBytes, WriteOptions const &opts) {
+            uint64_t rows = H;
+            if (opts.rowsPerStrip != 0)
+                rows = opts.rowsPerStrip;
+            else if (opts.stripBytes != 0)
+                rows = std::max<uint64_t>(1, opts.stripBytes / std::max<uint64_t>(1, uint64_t(W) * pixelBytes));
+            return uint32_t(std::max<uint64_t>(1, std::min<uint64_t>(rows, H)));
+        }
+
+        /// Byte size of each block of a W x H layer: strips of stripRows() rows (the last one may be shorter),
+        /// or tileSize x tileSize tiles in row-major order
+        inline std::vector<uint64_t> blockSizes(uint32_t W, uint32_t H, uint32_t pixelBytes,
+                                                WriteOptions const &opts) {
+            uint32_t tileSize = opts.tileSize;
+            if (tileSize == 0) {
+                uint32_t rps = stripRows(W, H, pixelBytes, opts);
+                std::vector<uint64_t> sizes;
+                for (uint32_t r = 0; r < H; r += rps)
+                    sizes.push_back(uint64_t(W) * std::min(rps, H - r) * pixelBytes);
+                return sizes;
+            }
+            uint64_t across = (W + tileSize - 1) / tileSize;
+            uint64_t down = (H + tileSize - 1) / tileSize;
+            return std::vector<uint64_t>(across * down, uint64_t(tileSize) * tileSize * pixelBytes);
+        }
+
+        /// Bytes per pixel of a layer as written: every sample repeats the grid value
+        inline uint32_t pixelBytes(Layer const &layer) {
+            return layer.samplesPerPixel * uint32_t(sampleBytes(layer.sampleType));
+        }
+
+        /// Stream a grid as chunky pixel blocks (band0,band1,... per pixel) in the order of blockSizes(),
+        /// each sample stored little-endian. Strips are consecutive rows, so they form one continuous run of
+        /// bytes whatever their height. Edge tiles are padded with zeros. Only one chunk is buffered at a time.
+        template <typename T, typename Sink>
+        void writeBlocks(concord::Grid<T> const &g, uint32_t S, uint32_t tileSize, Sink &&sink) {
             uint32_t W = static_cast<uint32_t>(g.cols());
             uint32_t H = static_cast<uint32_t>(g.rows());
-            uint32_t S = layer.samplesPerPixel;
-            size_t sz = size_t(W) * H * S;
-            strips[i].resize(sz);
-            stripCounts[i] = uint32_t(sz);
-            // fill chunky: band0,band1,... per pixel
-            size_t idx = 0;
-            for (uint32_t r = 0; r < H; ++r) {
-                for (uint32_t c = 0; c < W; ++c) {
-                    uint8_t v = g(r, c);
-                    for (uint32_t s = 0; s < S; ++s) {
-                        strips[i][idx++] = v;
+            size_t pixelBytes = size_t(S) * sizeof(T);
+            std::vector<uint8_t> chunk;
+
+            if (tileSize == 0) {
+                size_t rowBytes = size_t(W) * pixelBytes;
+                chunk.resize(std::max(rowBytes, std::min(kWriteChunkBytes, rowBytes * H)));
+                size_t used = 0;
+                for (uint32_t r = 0; r < H; ++r) {
+                    uint8_t *out = chunk.data() + used;
+                    for (uint32_t c = 0; c < W; ++c) {
+                        T v = g(r, c);
+                        for (uint32_t s = 0; s < S; ++s, out += sizeof(T)) {
+                            Endian<true>::store(out, v);
+                        }
+                    }
+                    used += rowBytes;
+                    if (used + rowBytes > chunk.size()) {
+                        sink(chunk.data(), used);
+                        used = 0;
+                    }
+                }
+                if (used)
+                    sink(chunk.data(), used);
+                return;
+            }
+
+            uint32_t across = (W + tileSize - 1) / tileSize;
+            uint32_t down = (H + tileSize - 1) / tileSize;
+            for (uint32_t ty = 0; ty < down; ++ty) {
+                for (uint32_t tx = 0; tx < across; ++tx) {
+                    chunk.assign(size_t(tileSize) * tileSize * pixelBytes, 0);
+                    uint32_t r1 = std::min(H, (ty + 1) * tileSize);
+                    uint32_t c1 = std::min(W, (tx + 1) * tileSize);
+                    for (uint32_t r = ty * tileSize; r < r1; ++r) {
+                        uint8_t *out = chunk.data() + size_t(r - ty * tileSize) * tileSize * pixelBytes;
+                        for (uint32_t c = tx * tileSize; c < c1; ++c) {
+                            T v = g(r, c);
+                            for (uint32_t s = 0; s < S; ++s, out += sizeof(T)) {
+                                Endian<true>::store(out, v);
+                            }
+                        }
                     }
+                    sink(chunk.data(), chunk.size());
                 }
             }
         }
 
-        // --- 2) Compute strip offsets (right after the 8‐byte TIFF header) ---
-        uint32_t p = 8;
-        for (size_t i = 0; i < N; ++i) {
-            stripOffsets[i] = p;
-            p += stripCounts[i];
+        /// Raw bytes of block k in the order of blockSizes(): strip k of rowsPerStrip rows, or tile k with
+        /// zero-padded edges. Used for compressed layers, whose blocks are encoded independently.
+        template <typename T>
+        std::vector<uint8_t> blockBytes(concord::Grid<T> const &g, uint32_t S, uint32_t tileSize,
+                                        uint32_t rowsPerStrip, size_t k) {
+            uint32_t W = static_cast<uint32_t>(g.cols());
+            uint32_t H = static_cast<uint32_t>(g.rows());
+            size_t pixelBytes = size_t(S) * sizeof(T);
+            uint32_t r0, r1, c0, c1, blockWidth;
+            if (tileSize == 0) {
+                r0 = uint32_t(k) * rowsPerStrip;
+                r1 = std::min(H, r0 + rowsPerStrip);
+                c0 = 0;
+                c1 = W;
+                blockWidth = W;
+            } else {
+                uint32_t across = (W + tileSize - 1) / tileSize;
+                r0 = uint32_t(k / across) * tileSize;
+                c0 = uint32_t(k % across) * tileSize;
+                r1 = std::min(H, r0 + tileSize);
+                c1 = std::min(W, c0 + tileSize);
+                blockWidth = tileSize;
+            }
+            uint32_t blockRows = tileSize == 0 ? r1 - r0 : tileSize;
+
+            std::vector<uint8_t> block(size_t(blockWidth) * blockRows * pixelBytes, 0);
+            for (uint32_t r = r0; r < r1; ++r) {
+                uint8_t *out = block.data() + size_t(r - r0) * blockWidth * pixelBytes;
+                for (uint32_t c = c0; c < c1; ++c) {
+                    T v = g(r, c);
+                    for (uint32_t s = 0; s < S; ++s, out += sizeof(T)) {
+                        Endian<true>::store(out, v);
+                    }
+                }
+            }
+            return block;
         }
-        uint32_t firstIFD = p;
 
-        // --- 3) Prepare per-layer metadata ---
-        std::vector<std::string> descriptions(N);
-        std::vector<uint32_t> descLengths(N);
-        std::vector<uint32_t> descOffsets(N);
-        std::vector<uint32_t> scaleOffsets(N);
-        std::vector<uint32_t> geoKeyOffsets(N);
-        std::vector<uint32_t> tiepointOffsets(N);
+        /// Compress the blocks of a layer with its codec and hand them to emit(block) in block order. Blocks are
+        /// encoded in batches of a few per thread on opts.threads threads, and a batch is released once emitted,
+        /// so only one batch is held at a time. Lazy layers are decoded into a temporary grid first.
+        template <typename Emit>
+        void encodeLayer(Layer const &layer, uint32_t W, uint32_t H, WriteOptions const &opts, Emit &&emit) {
+            if (!compressionAvailable(layer.compression))
+                throw std::runtime_error("compression " + std::to_string(uint16_t(layer.compression)) +
+                                         " is not available in this build");
+            size_t count = blockSizes(W, H, pixelBytes(layer), opts).size();
+            uint32_t rowsPerStrip = stripRows(W, H, pixelBytes(layer), opts);
+            unsigned threads = resolveThreads(opts.threads);
+            auto encode = [&](auto const &g) {
+                if (sampleTypeOf(g) != layer.sampleType)
+                    throw std::runtime_error("layer grid does not hold its sampleType");
+                size_t rowBytes = size_t(opts.tileSize ? opts.tileSize : W) * pixelBytes(layer);
+                size_t B = sampleBytes(layer.sampleType);
+                std::vector<std::vector<uint8_t>> batch(size_t(threads) * 4);
+                for (size_t first = 0; first < count; first += batch.size()) {
+                    size_t n = std::min(batch.size(), count - first);
+                    parallelFor(n, threads, [&](size_t j) {
+                        auto raw = blockBytes(g, layer.samplesPerPixel, opts.tileSize, rowsPerStrip, first + j);
+                        applyPredictor<true>(layer.predictor, raw.data(), raw.size() / rowBytes, rowBytes / B,
+                                             layer.samplesPerPixel, B);
+                        batch[j] = encodeBlock(layer.compression, raw.data(), raw.size());
+                    });
+                    for (size_t j = 0; j < n; ++j) {
+                        emit(std::as_const(batch[j]));
+                        batch[j] = {};
+                    }
+                }
+            };
+            if (layer.isMaterialized())
+                layer.visitGrid(encode);
+            else
+                std::visit(encode, layer.gridLoader());
+        }
 
-        for (size_t i = 0; i < N; ++i) {
-            auto const &layer = rc.layers[i];
+        /// IFD entries of one layer whose blocks (strips or tiles) live at the given offsets.
+        inline std::vector<TagValue> layerEntries(Layer const &layer, uint32_t W, uint32_t H,
+                                                  std::vector<uint64_t> const &offsets,
+                                                  std::vector<uint64_t> const &counts, WriteOptions const &opts,
+                                                  bool bigTiff) {
+            uint32_t tileSize = opts.tileSize;
+            std::vector<TagValue> E;
 
             // Build ImageDescription for this layer
+            std::string description;
             if (!layer.imageDescription.empty()) {
-                descriptions[i] = layer.imageDescription; // Use custom description if provided
+                description = layer.imageDescription; // Use custom description if provided
             } else {
                 // Generate geospatial description (always WGS84)
-                descriptions[i] = "CRS WGS84 DATUM " + std::to_string(layer.datum.lat) + " " +
-                                  std::to_string(layer.datum.lon) + " " + std::to_string(layer.datum.alt) + " SHIFT " +
-                                  std::to_string(layer.shift.point.x) + " " + std::to_string(layer.shift.point.y) +
-                                  " " + std::to_string(layer.shift.point.z) + " " +
-                                  std::to_string(layer.shift.angle.yaw);
+                description = "CRS WGS84 DATUM " + std::to_string(layer.datum.lat) + " " +
+                              std::to_string(layer.datum.lon) + " " + std::to_string(layer.datum.alt) + " SHIFT " +
+                              std::to_string(layer.shift.point.x) + " " + std::to_string(layer.shift.point.y) + " " +
+                              std::to_string(layer.shift.point.z) + " " + std::to_string(layer.shift.angle.yaw);
             }
 
-            descLengths[i] = uint32_t(descriptions[i].size() + 1);
-        }
+            uint16_t bitsPerSample = uint16_t(8 * sampleBytes(layer.sampleType));
+            if (layer.subfileType != 0)
+                E.push_back(longTag(254, {layer.subfileType})); // NewSubfileType (1 = reduced resolution)
+            E.push_back(longTag(256, {W}));                                // ImageWidth
+            E.push_back(longTag(257, {H}));                                // ImageLength
+            E.push_back(shortTag(258, {bitsPerSample}));                   // BitsPerSample
+            E.push_back(shortTag(259, {uint16_t(layer.compression)}));     // Compression (1 = none)
+            E.push_back(shortTag(262, {1}));                               // Photometric (BlackIsZero)
+            E.push_back(asciiTag(270, description));                       // ImageDescription
+            E.push_back(shortTag(277, {uint16_t(layer.samplesPerPixel)})); // SamplesPerPixel
+            E.push_back(shortTag(284, {uint16_t(layer.planarConfig)}));    // PlanarConfiguration
+            if (layer.predictor != Predictor::None)
+                E.push_back(shortTag(317, {uint16_t(layer.predictor)})); // Predictor
+            if (layer.sampleType != SampleType::UInt8)
+                E.push_back(shortTag(339, {sampleFormat(layer.sampleType)})); // SampleFormat
+
+            if (tileSize == 0) {
+                uint32_t rowsPerStrip = stripRows(W, H, pixelBytes(layer), opts);
+                E.push_back(offsetTag(273, offsets, bigTiff)); // StripOffsets
+                E.push_back(longTag(278, {rowsPerStrip}));     // RowsPerStrip
+                E.push_back(offsetTag(279, counts, bigTiff));  // StripByteCounts
+            } else {
+                E.push_back(longTag(322, {tileSize}));         // TileWidth
+                E.push_back(longTag(323, {tileSize}));         // TileLength
+                E.push_back(offsetTag(324, offsets, bigTiff)); // TileOffsets
+                E.push_back(offsetTag(325, counts, bigTiff));  // TileByteCounts
+            }
 
-        // --- 4) Compute IFD offsets and sizes ---
-        std::vector<uint16_t> entryCounts(N);
-        std::vector<uint32_t> customDataOffsets(N);
-        std::vector<uint32_t> customDataSizes(N);
-
-        for (size_t i = 0; i < N; ++i) {
-            // Base tags: 9 standard + ImageDescription + PlanarConfig + ModelPixelScale + GeoKeyDirectory +
-            // ModelTiepointTag + custom tags
-            entryCounts[i] = 9 + 1 + 1 + 1 + 1 + 1 + static_cast<uint16_t>(rc.layers[i].customTags.size());
-
-            // Calculate space needed for multi-value custom tag data
-            customDataSizes[i] = 0;
-            for (const auto &[tag, values] : rc.layers[i].customTags) {
-                if (values.size() > 1) {
-                    customDataSizes[i] += static_cast<uint32_t>(values.size() * 4); // 4 bytes per uint32_t
-                }
+            // ModelPixelScaleTag: X, Y, Z
+            E.push_back(doubleTag(33550, {layer.resolution, layer.resolution, 0.0}));
+
+            // ModelTiepointTag: I,J,K,X,Y,Z where (I,J,K) are pixel coords and (X,Y,Z) are world coords.
+            // We tie the center of the image to the WGS84 position of the ENU shift.
+            concord::ENU enuShift{layer.shift.point.x, layer.shift.point.y, layer.shift.point.z, layer.datum};
+            concord::WGS anchorWGS = enuShift.toWGS();
+            E.push_back(doubleTag(33922, {W / 2.0, H / 2.0, 0.0, anchorWGS.lon, anchorWGS.lat, anchorWGS.alt}));
+
+            // GeoKeyDirectoryTag (always WGS84): header, then {KeyID, TIFFTagLocation, Count, Value} per key
+            E.push_back(shortTag(34735, {1, 1, 0, 4,          // KeyDirectoryVersion, Revision, Minor, NumberOfKeys
+                                         1024, 0, 1, 2,       // GTModelTypeGeoKey = Geographic
+                                         1025, 0, 1, 1,       // GTRasterTypeGeoKey = RasterPixelIsArea
+                                         2048, 0, 1, 4326,    // GeographicTypeGeoKey = EPSG:4326 (WGS84)
+                                         2054, 0, 1, 9102})); // GeogAngularUnitsGeoKey = degree
+
+            // Custom tags for this layer
+            for (const auto &[tag, values] : layer.customTags) {
+                E.push_back(longTag(tag, values));
             }
+            return E;
         }
 
-        std::vector<uint32_t> ifdSizes(N);
-        for (size_t i = 0; i < N; ++i) {
-            ifdSizes[i] = 2 + entryCounts[i] * 12 + 4; // entry count + entries + next IFD pointer
-        }
+        // ------------------------------------------------------------------
+        // File layout: header, all pixel blocks, then the IFDs on a word boundary; or, cloud-optimized,
+        // header, GDAL's structural metadata, the IFDs, then the pixel blocks
+        // ------------------------------------------------------------------
+        struct FileLayout {
+            bool bigTiff = false;
+            /// Whether blockCounts are the final sizes; otherwise compressed IFDs hold upper bounds until written
+            bool exact = true;
+            std::vector<uint32_t> widths, heights;
+            std::vector<std::vector<uint64_t>> blockOffsets, blockCounts;
+            std::vector<std::vector<TagValue>> entries;
+            std::vector<uint64_t> ifdOffsets;
+            /// Layer behind each IFD, in file order: the collection's layers, each followed by its overviews
+            std::vector<Layer const *> ifds;
+            /// Overview levels planned for this write, per collection layer (pointed to from ifds); metadata only
+            std::vector<std::vector<Layer>> overviews;
+            /// IFD of the collection layer each IFD belongs to (itself for the collection's own layers)
+            std::vector<size_t> base;
+            /// IFDs in the order their blocks appear in the file
+            std::vector<size_t> dataOrder;
+            /// Bytes between the header and the first IFD (cloud-optimized layout only)
+            std::string ghost;
+            uint64_t totalSize = 0;
+        };
 
-        std::vector<uint32_t> ifdOffsets(N);
-        p = firstIFD;
-        for (size_t i = 0; i < N; ++i) {
-            ifdOffsets[i] = p;
-            p += ifdSizes[i];
+        /// GDAL's "ghost area" after a COG header: a size line, then key=value lines describing the layout,
+        /// padded to a word boundary
+        inline std::string cogStructuralMetadata() {
+            std::string body = "LAYOUT=IFDS_BEFORE_DATA\nBLOCK_ORDER=ROW_MAJOR\nKNOWN_INCOMPATIBLE_EDITION=NO\n";
+            constexpr size_t kSizeLine = 43; // "GDAL_STRUCTURAL_METADATA_SIZE=000000 bytes\n"
+            if ((kSizeLine + body.size()) % 2)
+                body += ' ';
+            std::string size = std::to_string(body.size());
+            return "GDAL_STRUCTURAL_METADATA_SIZE=" + std::string(6 - size.size(), '0') + size + " bytes\n" + body;
         }
 
-        // --- 5) Compute offsets for variable-length data ---
-        for (size_t i = 0; i < N; ++i) {
-            descOffsets[i] = p;
-            p += descLengths[i];
+        /// Place every block and IFD, given the byte size of each IFD's blocks. No pixels are touched,
+        /// so the result tells up front whether the file fits classic TIFF (TiffFormat::Auto promotes if not).
+        inline FileLayout planLayout(std::vector<Layer const *> const &ifds, std::vector<uint32_t> const &widths,
+                                     std::vector<uint32_t> const &heights,
+                                     std::vector<std::vector<uint64_t>> const &blockSizes, WriteOptions const &opts) {
+            size_t N = ifds.size();
+            std::vector<size_t> order(N);
+            for (size_t i = 0; i < N; ++i)
+                order[i] = i;
+            if (opts.cloudOptimized) {
+                std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                    return uint64_t(widths[a]) * heights[a] < uint64_t(widths[b]) * heights[b];
+                });
+            }
 
-            scaleOffsets[i] = p;
-            p += 24; // 3 doubles = 24 bytes
+            auto place = [&](bool bigTiff) {
+                FileLayout out;
+                out.bigTiff = bigTiff;
+                out.blockOffsets.resize(N);
+                out.blockCounts = blockSizes;
+                out.entries.resize(N);
+                out.ifdOffsets.resize(N);
+                out.ifds = ifds;
+                out.widths = widths;
+                out.heights = heights;
+                out.dataOrder = order;
+
+                auto placeBlocks = [&](uint64_t &p) {
+                    for (size_t i : order) {
+                        out.blockOffsets[i].clear();
+                        for (auto size : blockSizes[i]) {
+                            out.blockOffsets[i].push_back(p);
+                            p += size;
+                        }
+                    }
+                };
+                auto fillEntries = [&]() {
+                    for (size_t i = 0; i < N; ++i)
+                        out.entries[i] = layerEntries(*ifds[i], widths[i], heights[i], out.blockOffsets[i],
+                                                      out.blockCounts[i], opts, bigTiff);
+                };
+                auto placeIFDs = [&](uint64_t &p) {
+                    for (size_t i = 0; i < N; ++i) {
+                        out.ifdOffsets[i] = p;
+                        p += ifdSize(out.entries[i], bigTiff);
+                    }
+                };
+
+                uint64_t p = bigTiff ? 16 : 8; // header
+                if (!opts.cloudOptimized) {
+                    placeBlocks(p);
+                    p += p % 2;
+                    fillEntries();
+                    placeIFDs(p);
+                } else {
+                    // IFD sizes depend on the number of blocks only, so size them with placeholder offsets,
+                    // place the blocks behind them and fill in the real offsets
+                    out.ghost = cogStructuralMetadata();
+                    p += out.ghost.size();
+                    for (size_t i = 0; i < N; ++i)
+                        out.blockOffsets[i].assign(blockSizes[i].size(), 0);
+                    fillEntries();
+                    placeIFDs(p);
+                    placeBlocks(p);
+                    fillEntries();
+                }
+                out.totalSize = p;
+                return out;
+            };
+
+            if (opts.format == TiffFormat::BigTiff)
+                return place(true);
+            FileLayout classic = place(false);
+            if (classic.totalSize <= 0xFFFFFFFFull)
+                return classic;
+            if (opts.format == TiffFormat::Classic)
+                throw std::runtime_error("toTiffBytes(): " + std::to_string(classic.totalSize) +
+                                         " bytes exceed the 4 GiB classic TIFF limit");
+            return place(true);
+        }
 
-            geoKeyOffsets[i] = p;
-            p += 56; // GeoKeyDirectory = 56 bytes (4 keys for WGS84)
+        /// planLayout for the layers of rc, one IFD each
+        inline FileLayout planLayout(RasterCollection const &rc, std::vector<uint32_t> const &widths,
+                                     std::vector<uint32_t> const &heights,
+                                     std::vector<std::vector<uint64_t>> const &blockSizes, WriteOptions const &opts) {
+            std::vector<Layer const *> ifds;
+            for (auto const &layer : rc.layers)
+                ifds.push_back(&layer);
+            return planLayout(ifds, widths, heights, blockSizes, opts);
+        }
 
-            tiepointOffsets[i] = p;
-            p += 48; // ModelTiepointTag = 48 bytes (6 doubles)
+        /// Overview levels of a layer of W x H pixels as layers of their own, metadata only: each half the size of
+        /// the one before (rounded up, as downsample() does), down to one tile (one pixel for strips), with
+        /// NewSubfileType = 1, twice the resolution and the parent's codec
+        inline std::vector<Layer> overviewLevels(Layer const &layer, uint32_t W, uint32_t H, WriteOptions const &opts) {
+            uint32_t limit = opts.tileSize ? opts.tileSize : 1;
+            std::vector<Layer> levels;
+            double resolution = layer.resolution;
+            for (uint32_t k = 0; k < opts.overviewLevels; ++k) {
+                if (H <= limit && W <= limit)
+                    break;
+                W = (W + 1) / 2;
+                H = (H + 1) / 2;
+                resolution *= 2;
+                Layer ov;
+                ov.subfileType = 1;
+                ov.sampleType = layer.sampleType;
+                ov.width = W;
+                ov.height = H;
+                ov.samplesPerPixel = layer.samplesPerPixel;
+                ov.planarConfig = layer.planarConfig;
+                ov.compression = layer.compression;
+                ov.predictor = layer.predictor;
+                ov.datum = layer.datum;
+                ov.shift = layer.shift;
+                ov.resolution = resolution;
+                ov.imageDescription = layer.imageDescription;
+                levels.push_back(std::move(ov));
+            }
+            return levels;
+        }
 
-            // Custom tag data offset
-            customDataOffsets[i] = p;
-            p += customDataSizes[i];
+        /// Fill the levels planned by overviewLevels() with pixels, each downsampled from the one before
+        template <typename T>
+        void buildOverviews(concord::Grid<T> const &g, Layer const &layer, WriteOptions const &opts,
+                            std::vector<Layer> &levels) {
+            unsigned threads = resolveThreads(opts.threads);
+            const concord::Grid<T> *prev = &g;
+            for (auto &ov : levels) {
+                ov.setGrid(downsample(*prev, layer.overviewResampling, ov.resolution, layer.shift, threads));
+                prev = &std::as_const(ov).template gridAs<T>();
+            }
         }
 
-        uint32_t totalSize = p;
+        /// The pixels behind each IFD of a layout. Collection layers are handed out as they are; overview levels
+        /// are built for one collection layer at a time, on first use, and held until release(). A lazy layer
+        /// with overviews is decoded once for both itself and its levels.
+        class LevelSource {
+            std::vector<Layer const *> const &ifds_;
+            std::vector<size_t> const &base_;
+            WriteOptions const &opts_;
+            size_t of_ = SIZE_MAX;
+            Layer decoded_;
+            std::vector<Layer> levels_;
+
+            bool hasOverviews(size_t b) const { return b + 1 < ifds_.size() && base_[b + 1] == b; }
+
+            void load(size_t b) {
+                if (of_ == b)
+                    return;
+                release();
+                Layer const &layer = *ifds_[b];
+                for (size_t i = b + 1; i < ifds_.size() && base_[i] == b; ++i)
+                    levels_.push_back(*ifds_[i]);
+                if (!layer.isMaterialized()) {
+                    decoded_ = layer;
+                    decoded_.materialize();
+                    if (decoded_.sampleType != layer.sampleType)
+                        throw std::runtime_error("layer grid does not hold its sampleType");
+                }
+                Layer const &src = layer.isMaterialized() ? layer : decoded_;
+                src.visitGrid([&](auto const &g) { buildOverviews(g, layer, opts_, levels_); });
+                of_ = b;
+            }
 
-        // --- 5) Allocate final buffer ---
-        std::vector<uint8_t> buf(totalSize);
-        size_t writePos = 0;
+          public:
+            LevelSource(std::vector<Layer const *> const &ifds, std::vector<size_t> const &base,
+                        WriteOptions const &opts)
+                : ifds_(ifds), base_(base), opts_(opts) {}
+
+            Layer const &operator()(size_t i) {
+                size_t b = base_[i];
+                if (b == i && (ifds_[i]->isMaterialized() || !hasOverviews(i)))
+                    return *ifds_[i];
+                load(b);
+                return b == i ? decoded_ : levels_[i - b - 1];
+            }
 
-        // LE writers
-        auto writeLE16 = [&](uint16_t v) {
-            buf[writePos++] = uint8_t(v & 0xFF);
-            buf[writePos++] = uint8_t(v >> 8);
-        };
-        auto writeLE32 = [&](uint32_t v) {
-            buf[writePos++] = uint8_t(v & 0xFF);
-            buf[writePos++] = uint8_t((v >> 8) & 0xFF);
-            buf[writePos++] = uint8_t((v >> 16) & 0xFF);
-            buf[writePos++] = uint8_t((v >> 24) & 0xFF);
-        };
-        auto writeDouble = [&](double d) {
-            uint64_t bits;
-            std::memcpy(&bits, &d, sizeof(d));
-            for (int i = 0; i < 8; ++i) {
-                buf[writePos++] = uint8_t((bits >> (8 * i)) & 0xFF);
+            /// Free the levels (and decoded grid) held for the current collection layer
+            void release() {
+                of_ = SIZE_MAX;
+                decoded_ = Layer{};
+                levels_ = {};
             }
         };
 
-        // --- 6) TIFF header ---
-        buf[writePos++] = 'I';
-        buf[writePos++] = 'I'; // little‐endian
-        writeLE16(42);         // magic
-        writeLE32(firstIFD);   // offset to first IFD
+        /// Validate rc and plan its layout from layer dimensions alone (lazy layers stay unread). Compressed blocks
+        /// are planned at their encodeBound and placed for real as streamTiff encodes them. Only when those bounds
+        /// could pass 4 GiB are the compressed layers encoded once up front, a batch at a time and keeping their
+        /// sizes alone, to settle classic TIFF versus BigTIFF exactly. Overviews are planned from dimensions alone.
+        inline FileLayout planCollection(RasterCollection const &rc, WriteOptions const &opts, std::string const &who) {
+            if (rc.layers.empty())
+                throw std::runtime_error(who + ": no layers");
+            if (opts.tileSize % 16 != 0)
+                throw std::runtime_error(who + ": tile size must be a multiple of 16");
+            if (opts.cloudOptimized && opts.tileSize == 0)
+                throw std::runtime_error(who + ": a cloud-optimized layout needs tiles (set tileSize)");
+            for (auto const &layer : rc.layers) {
+                // Predictors follow libtiff: only the LZW and Deflate codecs carry them
+                if (layer.predictor != Predictor::None && layer.compression != Compression::LZW &&
+                    layer.compression != Compression::Deflate)
+                    throw std::runtime_error(who + ": a predictor needs LZW or Deflate compression");
+                bool isFloat = layer.sampleType == SampleType::Float32 || layer.sampleType == SampleType::Float64;
+                if (layer.predictor == Predictor::FloatingPoint && !isFloat)
+                    throw std::runtime_error(who + ": the floating-point predictor needs float samples");
+            }
 
-        // --- 7) Pixel data strips ---
-        for (size_t i = 0; i < N; ++i) {
-            std::memcpy(&buf[writePos], strips[i].data(), strips[i].size());
-            writePos += strips[i].size();
-        }
+            // IFD order: every layer followed by its overview levels, largest first. Overviews are planned from
+            // their dimensions; their pixels are only built by streamTiff.
+            std::vector<std::vector<Layer>> overviews(rc.layers.size());
+            std::vector<Layer const *> ifds;
+            std::vector<uint32_t> widths, heights;
+            std::vector<size_t> base;
+            for (size_t l = 0; l < rc.layers.size(); ++l) {
+                auto const &layer = rc.layers[l];
+                uint32_t W = layer.width, H = layer.height;
+                if (layer.isMaterialized()) {
+                    layer.visitGrid([&](auto const &g) {
+                        W = static_cast<uint32_t>(g.cols());
+                        H = static_cast<uint32_t>(g.rows());
+                    });
+                }
+                overviews[l] = overviewLevels(layer, W, H, opts);
+                base.push_back(ifds.size());
+                ifds.push_back(&layer);
+                widths.push_back(W);
+                heights.push_back(H);
+                for (auto const &ov : overviews[l]) {
+                    base.push_back(base.back());
+                    ifds.push_back(&ov);
+                    widths.push_back(ov.width);
+                    heights.push_back(ov.height);
+                }
+            }
 
-        // --- 8) IFDs ---
-        for (size_t i = 0; i < N; ++i) {
-            // Seek to the correct IFD position
-            writePos = ifdOffsets[i];
-
-            writeLE16(entryCounts[i]);
-
-            auto const &layer = rc.layers[i];
-            auto const &g = layer.grid;
-            uint32_t W = uint32_t(g.cols());
-            uint32_t H = uint32_t(g.rows());
-            uint32_t S = layer.samplesPerPixel;
-            uint32_t PC = layer.planarConfig;
-
-            // Tag 256: ImageWidth
-            writeLE16(256);
-            writeLE16(4);
-            writeLE32(1);
-            writeLE32(W);
-
-            // Tag 257: ImageLength
-            writeLE16(257);
-            writeLE16(4);
-            writeLE32(1);
-            writeLE32(H);
-
-            // Tag 258: BitsPerSample
-            writeLE16(258);
-            writeLE16(3);
-            writeLE32(1);
-            writeLE32(8);
-
-            // Tag 259: Compression (1 = uncompressed)
-            writeLE16(259);
-            writeLE16(3);
-            writeLE32(1);
-            writeLE32(1);
-
-            // Tag 262: PhotometricInterpretation (1 = BlackIsZero)
-            writeLE16(262);
-            writeLE16(3);
-            writeLE32(1);
-            writeLE32(1);
-
-            // Tag 270: ImageDescription
-            writeLE16(270);
-            writeLE16(2);
-            writeLE32(descLengths[i]);
-            writeLE32(descOffsets[i]);
-
-            // Tag 273: StripOffsets
-            writeLE16(273);
-            writeLE16(4);
-            writeLE32(1);
-            writeLE32(stripOffsets[i]);
-
-            // Tag 277: SamplesPerPixel
-            writeLE16(277);
-            writeLE16(3);
-            writeLE32(1);
-            writeLE32(S);
-
-            // Tag 278: RowsPerStrip
-            writeLE16(278);
-            writeLE16(4);
-            writeLE32(1);
-            writeLE32(H);
-
-            // Tag 279: StripByteCounts
-            writeLE16(279);
-            writeLE16(4);
-            writeLE32(1);
-            writeLE32(stripCounts[i]);
-
-            // Tag 284: PlanarConfiguration
-            writeLE16(284);
-            writeLE16(3);
-            writeLE32(1);
-            writeLE32(PC);
-
-            // Tag 33550: ModelPixelScaleTag
-            writeLE16(33550);
-            writeLE16(12);
-            writeLE32(3);
-            writeLE32(scaleOffsets[i]);
-
-            // Tag 34735: GeoKeyDirectoryTag
-            writeLE16(34735);
-            writeLE16(3);
-            writeLE32(14);
-            writeLE32(geoKeyOffsets[i]);
-
-            // Tag 33922: ModelTiepointTag
-            writeLE16(33922);
-            writeLE16(12);
-            writeLE32(6);
-            writeLE32(tiepointOffsets[i]);
-
-            // Write custom tags for this layer
-            uint32_t customDataPos = customDataOffsets[i];
-            for (const auto &[tag, values] : layer.customTags) {
-                writeLE16(tag);
-                writeLE16(4); // LONG type
-                writeLE32(static_cast<uint32_t>(values.size()));
-                if (values.size() == 1) {
-                    writeLE32(values[0]); // Value fits in offset field
-                } else {
-                    writeLE32(customDataPos); // Pointer to data
-                    customDataPos += static_cast<uint32_t>(values.size() * 4);
+            size_t N = ifds.size();
+            std::vector<std::vector<uint64_t>> sizes(N);
+            bool exact = true;
+            for (size_t i = 0; i < N; ++i) {
+                auto const &layer = *ifds[i];
+                sizes[i] = blockSizes(widths[i], heights[i], pixelBytes(layer), opts);
+                if (layer.compression != Compression::None) {
+                    for (auto &size : sizes[i])
+                        size = encodeBound(layer.compression, size);
+                    exact = false;
                 }
             }
 
-            // next IFD pointer
-            uint32_t next = (i + 1 < N ? ifdOffsets[i + 1] : 0);
-            writeLE32(next);
+            FileLayout layout;
+            if (exact || opts.format == TiffFormat::BigTiff) {
+                layout = planLayout(ifds, widths, heights, sizes, opts);
+            } else {
+                WriteOptions bounded = opts;
+                bounded.format = TiffFormat::Auto;
+                layout = planLayout(ifds, widths, heights, sizes, bounded);
+                if (layout.bigTiff) {
+                    // The bounds do not fit classic TIFF, but the encoded blocks may: measure them
+                    LevelSource levels(ifds, base, opts);
+                    for (size_t i = 0; i < N; ++i) {
+                        if (ifds[i]->compression != Compression::None) {
+                            sizes[i].clear();
+                            encodeLayer(levels(i), widths[i], heights[i], opts,
+                                        [&](std::vector<uint8_t> const &block) { sizes[i].push_back(block.size()); });
+                        }
+                        if (i + 1 == N || base[i + 1] != base[i])
+                            levels.release();
+                    }
+                    exact = true;
+                    layout = planLayout(ifds, widths, heights, sizes, opts);
+                }
+            }
+            layout.exact = exact;
+            layout.overviews = std::move(overviews); // moving keeps the layers where ifds points
+            layout.base = std::move(base);
+            return layout;
         }
 
-        // --- 9) Write variable-length data for each layer ---
-        for (size_t i = 0; i < N; ++i) {
-            auto const &layer = rc.layers[i];
-
-            // Description text + NUL
-            writePos = descOffsets[i];
-            std::memcpy(&buf[writePos], descriptions[i].data(), descriptions[i].size());
-            buf[writePos + descriptions[i].size()] = '\0';
-
-            // PixelScale doubles: X, Y, Z
-            writePos = scaleOffsets[i];
-            writeDouble(layer.resolution); // X scale
-            writeDouble(layer.resolution); // Y scale
-            writeDouble(0.0);              // Z scale
-
-            // GeoKeyDirectory for this layer (always WGS84)
-            writePos = geoKeyOffsets[i];
-            writeLE16(1); // KeyDirectoryVersion
-            writeLE16(1); // KeyRevision
-            writeLE16(0); // MinorRevision
-            writeLE16(4); // NumberOfKeys
-
-            // Key entry 1: GTModelTypeGeoKey
-            writeLE16(1024); // GTModelTypeGeoKey
-            writeLE16(0);    // TIFFTagLocation (0 means value is in ValueOffset)
-            writeLE16(1);    // Count
-            writeLE16(2);    // 2=Geographic (WGS84)
-
-            // Key entry 2: GTRasterTypeGeoKey
-            writeLE16(1025); // GTRasterTypeGeoKey
-            writeLE16(0);    // TIFFTagLocation
-            writeLE16(1);    // Count
-            writeLE16(1);    // RasterPixelIsArea
-
-            // Key entry 3: GeographicTypeGeoKey - EPSG:4326 for WGS84
-            writeLE16(2048); // GeographicTypeGeoKey
-            writeLE16(0);    // TIFFTagLocation
-            writeLE16(1);    // Count
-            writeLE16(4326); // EPSG:4326 (WGS84)
-
-            // Key entry 4: GeogAngularUnitsGeoKey - degrees for WGS84
-            writeLE16(2054); // GeogAngularUnitsGeoKey
-            writeLE16(0);    // TIFFTagLocation
-            writeLE16(1);    // Count
-            writeLE16(9102); // 9102=degree
-
-            // Write ModelTiepointTag for this layer
-            writePos = tiepointOffsets[i];
-            auto const &g = layer.grid;
-            uint32_t W = uint32_t(g.cols());
-            uint32_t H = uint32_t(g.rows());
-
-            // Tiepoint format: I,J,K,X,Y,Z where (I,J,K) are pixel coords and (X,Y,Z) are world coords
-            // We'll tie the center of the image to the world coordinates calculated from shift
-            writeDouble(W / 2.0); // I: pixel column (center)
-            writeDouble(H / 2.0); // J: pixel row (center)
-            writeDouble(0.0);     // K: always 0 for 2D
-
-            // Convert shift (ENU) to WGS84 coordinates using datum
-            concord::ENU enuShift{layer.shift.point.x, layer.shift.point.y, layer.shift.point.z, layer.datum};
-            concord::WGS anchorWGS = enuShift.toWGS();
-
-            writeDouble(anchorWGS.lon); // X: longitude
-            writeDouble(anchorWGS.lat); // Y: latitude
-            writeDouble(anchorWGS.alt); // Z: altitude
+        /// Emit the whole file front to back through sink(const uint8_t *, size_t): header, pixel blocks
+        /// layer by layer, then the IFDs (or, cloud-optimized, the IFDs first and the blocks in
+        /// layout.dataOrder after them). Lazy layers are decoded one at a time and released after writing, and
+        /// so are a layer's overview levels, built right before the first of them is written.
+        /// Compressed layers are encoded a batch of blocks at a time as they are written, and the offsets and
+        /// sizes they end up with are filled in afterwards through patch(offset, const uint8_t *, size_t),
+        /// which overwrites bytes already sunk: the first-IFD offset in the header and, cloud-optimized, the IFDs.
+        template <typename Sink, typename Patch>
+        void streamTiff(WriteOptions const &opts, FileLayout layout, Sink &&sink, Patch &&patch) {
+            size_t N = layout.ifds.size();
+
+            // --- 1) Header ---
+            std::vector<uint8_t> head;
+            head.push_back('I');
+            head.push_back('I'); // little‐endian
+            if (layout.bigTiff) {
+                putLE(head, 43, 2);                   // BigTIFF magic
+                putLE(head, 8, 2);                    // offset size
+                putLE(head, 0, 2);                    // reserved
+                putLE(head, layout.ifdOffsets[0], 8); // offset to first IFD
+            } else {
+                putLE(head, 42, 2);                   // magic
+                putLE(head, layout.ifdOffsets[0], 4); // offset to first IFD
+            }
+            uint64_t plannedFirstIFD = layout.ifdOffsets[0];
+            head.insert(head.end(), layout.ghost.begin(), layout.ghost.end());
+            sink(head.data(), head.size());
+            uint64_t written = head.size();
+
+            // --- 2) Pixel data blocks, at the offsets they actually land on ---
+            LevelSource levels(layout.ifds, layout.base, opts);
+            auto writeLayerBlocks = [&](size_t i) {
+                auto const &layer = levels(i);
+                if (layer.compression != Compression::None) {
+                    layout.blockOffsets[i].clear();
+                    layout.blockCounts[i].clear();
+                    encodeLayer(layer, layout.widths[i], layout.heights[i], opts,
+                                [&](std::vector<uint8_t> const &block) {
+                                    layout.blockOffsets[i].push_back(written);
+                                    layout.blockCounts[i].push_back(block.size());
+                                    sink(block.data(), block.size());
+                                    written += block.size();
+                                });
+                    return;
+                }
 
-            // Write custom tag data for this layer
-            writePos = customDataOffsets[i];
-            for (const auto &[tag, values] : layer.customTags) {
-                if (values.size() > 1) {
-                    for (uint32_t value : values) {
-                        writeLE32(value);
+                uint64_t expected = 0;
+                for (auto count : layout.blockCounts[i])
+                    expected += count;
+                uint64_t before = written;
+                auto write = [&](auto const &g) {
+                    if (sampleTypeOf(g) != layer.sampleType)
+                        throw std::runtime_error("layer " + std::to_string(i) + " grid does not hold its sampleType");
+                    writeBlocks(g, layer.samplesPerPixel, opts.tileSize, [&](const uint8_t *data, size_t n) {
+                        sink(data, n);
+                        written += n;
+                    });
+                };
+                if (layer.isMaterialized())
+                    layer.visitGrid(write);
+                else
+                    std::visit(write, layer.gridLoader()); // lazily read layer, decode a temporary copy
+                if (written - before != expected)
+                    throw std::runtime_error("layer " + std::to_string(i) + " grid does not match its " +
+                                             std::to_string(layout.blockCounts[i].size()) + " planned blocks");
+                layout.blockOffsets[i].clear();
+                for (auto count : layout.blockCounts[i]) {
+                    layout.blockOffsets[i].push_back(before);
+                    before += count;
+                }
+            };
+            // A layer's overview levels are freed once the last IFD needing them is written
+            auto writeInOrder = [&](std::vector<size_t> const &order) {
+                std::vector<size_t> lastUse(N);
+                for (size_t k = 0; k < order.size(); ++k)
+                    lastUse[layout.base[order[k]]] = k;
+                for (size_t k = 0; k < order.size(); ++k) {
+                    writeLayerBlocks(order[k]);
+                    if (lastUse[layout.base[order[k]]] == k)
+                        levels.release();
+                }
+            };
+            auto fillEntries = [&]() {
+                for (size_t i = 0; i < N; ++i)
+                    layout.entries[i] = layerEntries(*layout.ifds[i], layout.widths[i], layout.heights[i],
+                                                     layout.blockOffsets[i], layout.blockCounts[i], opts,
+                                                     layout.bigTiff);
+            };
+
+            // --- 3) IFDs with their out-of-line values (on a word boundary) ---
+            auto serialize = [&](size_t i) {
+                uint64_t next = (i + 1 < N ? layout.ifdOffsets[i + 1] : 0);
+                return serializeIFD(layout.ifdOffsets[i], std::move(layout.entries[i]), next, layout.bigTiff);
+            };
+            auto writeIFDs = [&]() {
+                if (written % 2) {
+                    uint8_t pad = 0;
+                    sink(&pad, 1);
+                    ++written;
+                }
+                for (size_t i = 0; i < N; ++i) {
+                    layout.ifdOffsets[i] = written;
+                    written += ifdSize(layout.entries[i], layout.bigTiff);
+                }
+                for (size_t i = 0; i < N; ++i) {
+                    auto ifd = serialize(i);
+                    sink(ifd.data(), ifd.size());
+                }
+            };
+
+            if (opts.cloudOptimized) {
+                // IFD sizes depend on block counts alone, so the planned IFDs keep their place and only their
+                // offset and byte count arrays are rewritten once the blocks are down
+                writeIFDs();
+                writeInOrder(layout.dataOrder);
+                if (!layout.exact) {
+                    fillEntries();
+                    for (size_t i = 0; i < N; ++i) {
+                        auto ifd = serialize(i);
+                        patch(layout.ifdOffsets[i], ifd.data(), ifd.size());
                     }
                 }
+            } else {
+                std::vector<size_t> order(N);
+                for (size_t i = 0; i < N; ++i)
+                    order[i] = i;
+                writeInOrder(order);
+                fillEntries();
+                writeIFDs();
+            }
+
+            if (layout.ifdOffsets[0] != plannedFirstIFD) {
+                std::vector<uint8_t> first;
+                putLE(first, layout.ifdOffsets[0], layout.bigTiff ? 8 : 4);
+                patch(layout.bigTiff ? 8 : 4, first.data(), first.size());
             }
         }
+    } // namespace detail
 
+    /// Write out all layers in rc as a chained‐IFD GeoTIFF.
+    /// Each IFD can have its own CRS/DATUM/HEADING/PixelScale and custom tags.
+    /// opts.tileSize switches the pixel layout from one strip per layer to square tiles (tags 322-325).
+    /// opts.format picks classic TIFF or BigTIFF; by default BigTIFF is used only when offsets pass 4 GiB.
+    /// Layer::compression picks each layer's codec (PackBits, LZW, Deflate); blocks are compressed independently
+    /// on opts.threads threads. opts.cloudOptimized moves the IFDs in front of the tiles (COG layout).
+    ///
+    /// CRS Flavor Handling:
+    /// - ENU flavor: Grid data is already in local space, datum provides reference
+    /// - WGS flavor: Grid data represents WGS coordinates, datum provides reference
+    /// The Grid object contains the appropriate coordinate system based on parsing
+    inline std::vector<uint8_t> toTiffBytes(RasterCollection const &rc, WriteOptions const &opts = {}) {
+        detail::FileLayout layout = detail::planCollection(rc, opts, "toTiffBytes()");
+
+        std::vector<uint8_t> buf;
+        if (layout.exact)
+            buf.reserve(layout.totalSize);
+        detail::streamTiff(
+            opts, std::move(layout), [&](const uint8_t *data, size_t n) { buf.insert(buf.end(), data, data + n); },
+            [&](uint64_t at, const uint8_t *data, size_t n) { std::memcpy(buf.data() + at, data, n); });
         return buf;
     }
 
-    /// Write a multi‐IFD GeoTIFF to disk
-    inline void WriteRasterCollection(RasterCollection const &rc, fs::path const &outPath) {
-        auto bytes = toTiffBytes(rc);
+    /// Write a multi‐IFD GeoTIFF to disk.
+    /// The layout is planned up front and every block is streamed straight to the file, so besides the grids
+    /// themselves only about one chunk (kWriteChunkBytes, or one tile) is held in memory. Layers with a
+    /// Layer::compression hold one batch of encoded blocks at a time.
+    inline void WriteRasterCollection(RasterCollection const &rc, fs::path const &outPath,
+                                      WriteOptions const &opts = {}) {
+        detail::FileLayout layout = detail::planCollection(rc, opts, "WriteRasterCollection()");
+
         std::ofstream ofs(outPath, std::ios::binary);
         if (!ofs)
             throw std::runtime_error("cannot open " + outPath.string());
-        ofs.write(reinterpret_cast<char *>(bytes.data()), bytes.size());
+        detail::streamTiff(
+            opts, std::move(layout),
+            [&](const uint8_t *data, size_t n) {
+                ofs.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(n));
+            },
+            [&](uint64_t at, const uint8_t *data, size_t n) {
+                ofs.seekp(static_cast<std::streamoff>(at));
+                ofs.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(n));
+                ofs.seekp(0, std::ios::end);
+            });
+        ofs.flush();
+        if (!ofs)
+            throw std::runtime_error("failed writing " + outPath.string());
     }
 
 } // namespace geotiv
@@ -0,0 +1,66 @@
+#pragma once
+
+// Fixture shared by the test files: a datum and pose to place layers at, and builders for layers whose
+// pixels follow a per-test valueAt(r, c) pattern that reads can be checked against.
+
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace helpers {
+    inline const concord::Datum datum{47.5, 8.5, 200.0};
+    inline const concord::Pose shift{concord::Point{5, -2, 0}, concord::Euler{0, 0, 0.1}};
+
+    /// Single-band layer of rows x cols samples of type T with pixel (r, c) = valueAt(r, c), 0.5 m pixels
+    template <typename T, typename ValueAt>
+    geotiv::Layer makeLayer(size_t rows, size_t cols, ValueAt &&valueAt,
+                            geotiv::Compression compression = geotiv::Compression::None) {
+        concord::Grid<T> grid(rows, cols, 0.5, true, shift);
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t c = 0; c < cols; ++c)
+                grid(r, c) = T(valueAt(r, c));
+        geotiv::Layer layer;
+        layer.setGrid(std::move(grid));
+        layer.width = static_cast<uint32_t>(cols);
+        layer.height = static_cast<uint32_t>(rows);
+        layer.samplesPerPixel = 1;
+        layer.planarConfig = 1;
+        layer.datum = datum;
+        layer.shift = shift;
+        layer.resolution = 0.5;
+        layer.compression = compression;
+        return layer;
+    }
+
+    /// Collection of the given layers, placed like them
+    inline geotiv::RasterCollection collectionOf(std::vector<geotiv::Layer> layers) {
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 0.5;
+        rc.layers = std::move(layers);
+        return rc;
+    }
+
+    /// Whether g holds valueAt(row0 + r, col0 + c) at every (r, c), i.e. a window at (row0, col0)
+    template <typename T, typename ValueAt>
+    bool matches(const concord::Grid<T> &g, size_t row0, size_t col0, ValueAt &&valueAt) {
+        for (size_t r = 0; r < g.rows(); ++r)
+            for (size_t c = 0; c < g.cols(); ++c)
+                if (g(r, c) != T(valueAt(row0 + r, col0 + c)))
+                    return false;
+        return true;
+    }
+
+    template <typename T> bool sameGrid(const concord::Grid<T> &a, const concord::Grid<T> &b) {
+        return a.rows() == b.rows() && a.cols() == b.cols() &&
+               matches(a, 0, 0, [&](size_t r, size_t c) { return b(r, c); });
+    }
+
+    inline void writeBytes(const std::string &path, const std::vector<uint8_t> &bytes) {
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+} // namespace helpers
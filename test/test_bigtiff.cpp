@@ -0,0 +1,222 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <cstring>
+#include <doctest/doctest.h>
+#include <filesystem>
+
+using namespace helpers;
+
+namespace {
+    // Two-IFD BigTIFF (8-byte offsets, 20-byte entries). Each layer is stored in strips of rowsPerStrip
+    // rows with LONG8 strip arrays, an inline ASCII description "BIG k" and a DOUBLE pixel scale of 0.5.
+    // Pixel (r, c) of layer k holds (r * 16 + c + k) & 0xFF.
+    std::vector<uint8_t> makeBigTiff(uint32_t W, uint32_t H, uint32_t rowsPerStrip, bool bigEndian) {
+        std::vector<uint8_t> out;
+        auto putN = [&](uint64_t v, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                out.push_back(uint8_t(v >> (8 * (bigEndian ? n - 1 - i : i))));
+        };
+        auto patch64 = [&](size_t at, uint64_t v) {
+            for (size_t i = 0; i < 8; ++i)
+                out[at + i] = uint8_t(v >> (8 * (bigEndian ? 7 - i : i)));
+        };
+        // Entry with a single integer value (or an offset) left-justified in the 8-byte value field
+        auto entry = [&](uint16_t tag, uint16_t type, uint64_t count, uint64_t value, size_t valueSize) {
+            putN(tag, 2);
+            putN(type, 2);
+            putN(count, 8);
+            putN(value, valueSize);
+            putN(0, 8 - valueSize);
+        };
+
+        out.push_back(bigEndian ? 'M' : 'I');
+        out.push_back(bigEndian ? 'M' : 'I');
+        putN(43, 2);
+        putN(8, 2);
+        putN(0, 2);
+        size_t nextField = out.size();
+        putN(0, 8); // patched below
+
+        uint32_t strips = (H + rowsPerStrip - 1) / rowsPerStrip;
+        for (uint32_t k = 0; k < 2; ++k) {
+            std::vector<uint64_t> offsets, counts;
+            for (uint32_t s = 0; s < strips; ++s) {
+                offsets.push_back(out.size());
+                uint32_t rows = std::min(rowsPerStrip, H - s * rowsPerStrip);
+                counts.push_back(uint64_t(rows) * W);
+                for (uint32_t r = s * rowsPerStrip; r < s * rowsPerStrip + rows; ++r)
+                    for (uint32_t c = 0; c < W; ++c)
+                        out.push_back(uint8_t((r * 16 + c + k) & 0xFF));
+            }
+
+            uint64_t scaleAt = out.size();
+            for (double d : {0.5, 0.5, 0.0}) {
+                uint64_t bits;
+                std::memcpy(&bits, &d, 8);
+                putN(bits, 8);
+            }
+            uint64_t offsetsAt = out.size();
+            for (auto o : offsets)
+                putN(o, 8);
+            uint64_t countsAt = out.size();
+            for (auto c : counts)
+                putN(c, 8);
+
+            while (out.size() % 8)
+                out.push_back(0);
+            patch64(nextField, out.size());
+            putN(10, 8);
+            entry(256, 3, 1, W, 2);
+            entry(257, 3, 1, H, 2);
+            entry(258, 3, 1, 8, 2);
+            entry(259, 3, 1, 1, 2);
+            entry(262, 3, 1, 1, 2);
+            putN(270, 2);
+            putN(2, 2);
+            putN(6, 8);
+            for (char ch : std::string("BIG ") + char('0' + k))
+                out.push_back(uint8_t(ch));
+            putN(0, 3);
+            entry(273, 16, strips, strips == 1 ? offsets[0] : offsetsAt, 8);
+            entry(278, 4, 1, rowsPerStrip, 4);
+            entry(279, 16, strips, strips == 1 ? counts[0] : countsAt, 8);
+            entry(33550, 12, 3, scaleAt, 8);
+            nextField = out.size();
+            putN(0, 8);
+        }
+        return out;
+    }
+
+    // Collection of 8-bit layers, layer li holding (li * 31 + r * 7 + c) & 0xFF and a custom tag 50010
+    geotiv::RasterCollection makeCollection(size_t rows, size_t cols, int layers) {
+        std::vector<geotiv::Layer> all;
+        for (int li = 0; li < layers; ++li) {
+            auto layer =
+                makeLayer<uint8_t>(rows, cols, [li](size_t r, size_t c) { return (li * 31 + r * 7 + c) & 0xFF; });
+            layer.customTags[50010] = {static_cast<uint32_t>(li), 1u, 2u};
+            all.push_back(std::move(layer));
+        }
+        return collectionOf(std::move(all));
+    }
+} // namespace
+
+TEST_CASE("BigTIFF reading") {
+    SUBCASE("Multi-strip layers decode in both byte orders") {
+        for (bool bigEndian : {false, true}) {
+            std::string testFile = bigEndian ? "big_mm.tif" : "big_ii.tif";
+            writeBytes(testFile, makeBigTiff(23, 17, 5, bigEndian));
+
+            geotiv::RasterCollection rc;
+            REQUIRE_NOTHROW(rc = geotiv::ReadRasterCollection(testFile));
+            REQUIRE(rc.layers.size() == 2);
+            for (uint32_t k = 0; k < 2; ++k) {
+                const auto &L = rc.layers[k];
+                CHECK(L.stripOffsets.size() == 4);
+                CHECK(L.rowsPerStrip == 5);
+                CHECK(L.resolution == doctest::Approx(0.5));
+                CHECK(L.imageDescription == "BIG " + std::to_string(k));
+                REQUIRE(L.grid.rows() == 17);
+                REQUIRE(L.grid.cols() == 23);
+
+                CHECK(matches(L.grid, 0, 0, [k](size_t r, size_t c) { return (r * 16 + c + k) & 0xFF; }));
+            }
+            CHECK(rc.layers[1].ifdOffset > rc.layers[0].ifdOffset);
+
+            std::filesystem::remove(testFile);
+        }
+    }
+
+    SUBCASE("Single strip keeps its LONG8 offset inline") {
+        std::string testFile = "big_single.tif";
+        writeBytes(testFile, makeBigTiff(6, 4, 4, false));
+        auto rc = geotiv::ReadRasterCollection(testFile);
+        CHECK(rc.layers[0].stripOffsets.size() == 1);
+        CHECK(rc.layers[0].grid(3, 5) == uint8_t(3 * 16 + 5));
+        CHECK(rc.layers[1].grid(3, 5) == uint8_t(3 * 16 + 5 + 1));
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Metadata, lazy and windowed reads walk the BigTIFF IFD chain") {
+        std::string testFile = "big_window.tif";
+        writeBytes(testFile, makeBigTiff(23, 17, 5, true));
+
+        auto meta = geotiv::ReadRasterMetadata(testFile);
+        REQUIRE(meta.layers.size() == 2);
+        CHECK(meta.layers[1].grid.rows() == 0);
+
+        geotiv::ReadOptions opts;
+        opts.lazy = true;
+        auto lazy = geotiv::ReadRasterCollection(testFile, opts);
+        CHECK(lazy.layers[1].materialize()(16, 22) == uint8_t((16 * 16 + 22 + 1) & 0xFF));
+
+        auto win = geotiv::ReadWindow(testFile, 1, 4, 3, 7, 5);
+        REQUIRE(win.grid.rows() == 7);
+        REQUIRE(win.grid.cols() == 5);
+        CHECK(win.grid(0, 0) == uint8_t((4 * 16 + 3 + 1) & 0xFF));
+        CHECK(win.grid(6, 4) == uint8_t((10 * 16 + 7 + 1) & 0xFF));
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Unsupported BigTIFF offset size is rejected") {
+        std::string testFile = "big_bad.tif";
+        auto bytes = makeBigTiff(6, 4, 4, false);
+        bytes[4] = 4; // offset size must be 8
+        writeBytes(testFile, bytes);
+        CHECK_THROWS_AS(geotiv::ReadRasterCollection(testFile), std::runtime_error);
+        std::filesystem::remove(testFile);
+    }
+}
+
+TEST_CASE("BigTIFF writing") {
+    SUBCASE("Forced BigTIFF round trips strips and tiles") {
+        auto rc = makeCollection(45, 70, 2);
+        for (uint32_t tileSize : {0u, 32u}) {
+            geotiv::WriteOptions opts;
+            opts.tileSize = tileSize;
+            opts.format = geotiv::TiffFormat::BigTiff;
+            auto bytes = geotiv::toTiffBytes(rc, opts);
+            CHECK(bytes[2] == 43);
+            CHECK(bytes[4] == 8);
+
+            std::string testFile = "big_write.tif";
+            writeBytes(testFile, bytes);
+            auto back = geotiv::ReadRasterCollection(testFile);
+            REQUIRE(back.layers.size() == 2);
+            for (size_t li = 0; li < 2; ++li) {
+                const auto &L = back.layers[li];
+                CHECK(L.isTiled() == (tileSize != 0));
+                CHECK(L.customTags.at(50010) == std::vector<uint32_t>{static_cast<uint32_t>(li), 1u, 2u});
+                CHECK(L.datum.lat == doctest::Approx(datum.lat).epsilon(0.001));
+                CHECK(L.resolution == doctest::Approx(0.5));
+                CHECK(sameGrid(L.grid, rc.layers[li].grid));
+            }
+            std::filesystem::remove(testFile);
+        }
+    }
+
+    SUBCASE("Small collections stay classic TIFF by default") {
+        auto bytes = geotiv::toTiffBytes(makeCollection(8, 8, 1));
+        CHECK(bytes[2] == 42);
+    }
+
+    SUBCASE("Layouts past 4 GiB are promoted, or rejected in classic mode") {
+        // Plan only: two layers of 3 GiB each, no pixels are allocated
+        auto rc = makeCollection(1, 1, 2);
+        std::vector<uint32_t> widths{65536, 65536}, heights{49152, 49152};
+        std::vector<std::vector<uint64_t>> sizes{{3ull << 30}, {3ull << 30}};
+
+        auto layout = geotiv::detail::planLayout(rc, widths, heights, sizes, {});
+        CHECK(layout.bigTiff);
+        CHECK(layout.blockOffsets[1][0] == 16 + (3ull << 30));
+        CHECK(layout.ifdOffsets[0] > 0xFFFFFFFFull);
+
+        geotiv::WriteOptions classic;
+        classic.format = geotiv::TiffFormat::Classic;
+        CHECK_THROWS_AS(geotiv::detail::planLayout(rc, widths, heights, sizes, classic), std::runtime_error);
+
+        sizes = {{1ull << 30}, {1ull << 30}};
+        CHECK_FALSE(geotiv::detail::planLayout(rc, widths, heights, sizes, {}).bigTiff);
+    }
+}
@@ -0,0 +1,85 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <atomic>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <filesystem>
+
+using namespace helpers;
+
+namespace {
+    uint16_t valueAt(size_t r, size_t c) { return uint16_t(r * 131 + c * 7); }
+
+    geotiv::RasterCollection makeCollection(geotiv::Compression compression) {
+        return collectionOf({makeLayer<uint16_t>(90, 101, valueAt, compression),
+                             makeLayer<uint16_t>(33, 44, valueAt, compression)});
+    }
+} // namespace
+
+TEST_CASE("Byte sources") {
+    SUBCASE("fromTiffBytes parses what toTiffBytes wrote") {
+        for (auto compression : {geotiv::Compression::None, geotiv::Compression::LZW}) {
+            auto rc = makeCollection(compression);
+            for (uint32_t tileSize : {0u, 16u}) {
+                geotiv::WriteOptions opts;
+                opts.tileSize = tileSize;
+                opts.rowsPerStrip = 8;
+                auto bytes = geotiv::toTiffBytes(rc, opts);
+
+                geotiv::ReadOptions threaded;
+                threaded.threads = 4;
+                auto back = geotiv::fromTiffBytes(bytes, threaded);
+                REQUIRE(back.layers.size() == 2);
+                CHECK(back.datum.lat == doctest::Approx(datum.lat));
+                CHECK(matches(back.layers[0].gridAs<uint16_t>(), 0, 0, valueAt));
+                CHECK(matches(back.layers[1].gridAs<uint16_t>(), 0, 0, valueAt));
+
+                geotiv::ReadOptions lazy;
+                lazy.lazy = true;
+                CHECK(geotiv::toTiffBytes(geotiv::fromTiffBytes(bytes, lazy), opts) == bytes);
+
+                auto src = std::make_shared<geotiv::SpanSource>(bytes);
+                auto win = geotiv::ReadWindow(src, 0, 20, 30, 17, 25);
+                CHECK(matches(win.gridAs<uint16_t>(), 20, 30, valueAt));
+                CHECK(geotiv::ReadRasterMetadata(src).layers[1].width == 44);
+            }
+        }
+    }
+
+    SUBCASE("Callback sources see only positioned reads") {
+        auto bytes = geotiv::toTiffBytes(makeCollection(geotiv::Compression::LZW));
+        std::atomic<size_t> calls{0};
+        auto src = std::make_shared<geotiv::CallbackSource>(bytes.size(), [&](uint64_t offset, void *dst, size_t n) {
+            ++calls;
+            std::memcpy(dst, bytes.data() + offset, n);
+            return n;
+        });
+        geotiv::ReadOptions threaded;
+        threaded.threads = 4;
+        auto back = geotiv::ReadRasterCollection(src, threaded);
+        CHECK(calls > 0);
+        CHECK(matches(back.layers[0].gridAs<uint16_t>(), 0, 0, valueAt));
+        CHECK(matches(geotiv::ReadWindow(src, 1, 3, 4, 10, 10).gridAs<uint16_t>(), 3, 4, valueAt));
+    }
+
+    SUBCASE("Files read the same through openByteSource") {
+        auto rc = makeCollection(geotiv::Compression::LZW);
+        std::string file = "byte_source.tif";
+        geotiv::WriteRasterCollection(rc, file);
+        for (auto backend : {geotiv::ReadBackend::Stream, geotiv::ReadBackend::Mmap, geotiv::ReadBackend::Pread}) {
+            geotiv::ReadOptions opts{backend};
+            auto back = geotiv::ReadRasterCollection(geotiv::openByteSource(file, opts), opts);
+            CHECK(matches(back.layers[1].gridAs<uint16_t>(), 0, 0, valueAt));
+        }
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("Truncated buffers and missing sources are errors") {
+        auto bytes = geotiv::toTiffBytes(makeCollection(geotiv::Compression::LZW));
+        CHECK_THROWS_AS(geotiv::fromTiffBytes(std::span<const uint8_t>(bytes.data(), bytes.size() - 100)),
+                        std::runtime_error);
+        CHECK_THROWS_AS(geotiv::fromTiffBytes(std::span<const uint8_t>(bytes.data(), 4)), std::runtime_error);
+        CHECK_THROWS_AS(geotiv::ReadRasterCollection(std::shared_ptr<geotiv::ByteSource>{}), std::invalid_argument);
+    }
+}
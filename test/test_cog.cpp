@@ -0,0 +1,91 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <algorithm>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <string>
+
+using namespace helpers;
+
+namespace {
+    // Two layers of blocky 8-bit classes, largest first as a full-resolution layer would be
+    geotiv::RasterCollection makeCollection(geotiv::Compression compression = geotiv::Compression::None) {
+        auto blocks = [](uint8_t seed) {
+            return [seed](size_t r, size_t c) { return uint8_t(seed + (r / 4) * 3 + c / 8); };
+        };
+        return collectionOf({makeLayer<uint8_t>(150, 170, blocks(1), compression),
+                             makeLayer<uint8_t>(40, 50, blocks(90), compression)});
+    }
+} // namespace
+
+TEST_CASE("Cloud-optimized layout") {
+    geotiv::WriteOptions cog;
+    cog.tileSize = 32;
+    cog.cloudOptimized = true;
+
+    SUBCASE("IFDs and tag data precede every tile, smallest layer's tiles first") {
+        auto bytes = geotiv::toTiffBytes(makeCollection(), cog);
+        std::string ghost(bytes.begin() + 8, bytes.begin() + 8 + 43);
+        CHECK(ghost == "GDAL_STRUCTURAL_METADATA_SIZE=000077 bytes\n");
+        std::string body(bytes.begin() + 51, bytes.begin() + 51 + 77);
+        CHECK(body.find("LAYOUT=IFDS_BEFORE_DATA\n") == 0);
+
+        uint32_t firstIFD = bytes[4] | bytes[5] << 8 | bytes[6] << 16 | uint32_t(bytes[7]) << 24;
+        CHECK(firstIFD == 8 + 43 + 77);
+
+        std::string file = "cog_layout.tif";
+        writeBytes(file, bytes);
+        auto meta = geotiv::ReadRasterMetadata(file);
+        REQUIRE(meta.layers.size() == 2);
+        auto const &big = meta.layers[0];
+        auto const &small = meta.layers[1];
+        uint64_t directoryEnd = *std::min_element(small.tileOffsets.begin(), small.tileOffsets.end());
+        CHECK(big.ifdOffset < directoryEnd);
+        CHECK(small.ifdOffset < directoryEnd);
+
+        // Row-major and back to back: the small layer's tiles, then the big layer's
+        auto contiguous = [](geotiv::Layer const &L, uint64_t start) {
+            for (size_t k = 0; k < L.tileOffsets.size(); ++k) {
+                if (L.tileOffsets[k] != start)
+                    return false;
+                start += L.tileByteCounts[k];
+            }
+            return true;
+        };
+        CHECK(contiguous(small, directoryEnd));
+        CHECK(contiguous(big, small.tileOffsets.back() + small.tileByteCounts.back()));
+        CHECK(big.tileOffsets.back() + big.tileByteCounts.back() == bytes.size());
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("Pixels read back the same as from the default layout") {
+        for (auto compression : {geotiv::Compression::None, geotiv::Compression::LZW}) {
+            auto rc = makeCollection(compression);
+            for (auto format : {geotiv::TiffFormat::Classic, geotiv::TiffFormat::BigTiff}) {
+                cog.format = format;
+                std::string file = "cog_roundtrip.tif";
+                geotiv::WriteRasterCollection(rc, file, cog);
+                auto back = geotiv::ReadRasterCollection(file);
+                REQUIRE(back.layers.size() == 2);
+                for (size_t i = 0; i < 2; ++i)
+                    CHECK(sameGrid(back.layers[i].grid, rc.layers[i].grid));
+
+                auto win = geotiv::ReadWindow(file, 0, 40, 50, 20, 30);
+                CHECK(win.grid(3, 4) == rc.layers[0].grid(43, 54));
+
+                geotiv::ReadOptions lazyOpts;
+                lazyOpts.lazy = true;
+                CHECK(geotiv::toTiffBytes(geotiv::ReadRasterCollection(file, lazyOpts), cog) ==
+                      geotiv::toTiffBytes(rc, cog));
+                std::filesystem::remove(file);
+            }
+        }
+    }
+
+    SUBCASE("The layout needs tiles") {
+        geotiv::WriteOptions strips;
+        strips.cloudOptimized = true;
+        CHECK_THROWS_AS(geotiv::toTiffBytes(makeCollection(), strips), std::runtime_error);
+    }
+}
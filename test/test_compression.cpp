@@ -0,0 +1,266 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+using namespace helpers;
+
+namespace {
+    // Occlusion-like layer: long runs of a few classes with some noise rows
+    uint8_t runAt(size_t r, size_t c) {
+        return (r % 17 == 3) ? uint8_t((r * 131 + c * 71) & 0xFF) : uint8_t((c / 40 + r / 25) % 3);
+    }
+
+    geotiv::RasterCollection makeRuns(size_t rows, size_t cols, geotiv::Compression compression) {
+        return collectionOf({makeLayer<uint8_t>(rows, cols, runAt, compression)});
+    }
+
+    // SHORT/LONG values of the first IFD of a little-endian classic TIFF, by tag (first value only)
+    std::map<uint16_t, uint32_t> firstIFD(const std::vector<uint8_t> &bytes) {
+        auto u16 = [&](size_t at) { return uint32_t(bytes[at] | bytes[at + 1] << 8); };
+        auto u32 = [&](size_t at) { return u16(at) | u16(at + 2) << 16; };
+        size_t ifd = u32(4);
+        std::map<uint16_t, uint32_t> tags;
+        for (uint32_t i = 0; i < u16(ifd); ++i) {
+            size_t e = ifd + 2 + i * 12;
+            tags[uint16_t(u16(e))] = u16(e + 2) == 3 ? u16(e + 8) : u32(e + 8);
+        }
+        return tags;
+    }
+} // namespace
+
+TEST_CASE("Compressed writing") {
+    SUBCASE("PackBits matches the reference example") {
+        // Apple TN1023 sample
+        std::vector<uint8_t> raw = {0xAA, 0xAA, 0xAA, 0x80, 0x00, 0x2A, 0xAA, 0xAA, 0xAA, 0xAA, 0x80, 0x00,
+                                    0x2A, 0x22, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA};
+        std::vector<uint8_t> packed = {0xFE, 0xAA, 0x02, 0x80, 0x00, 0x2A, 0xFD, 0xAA,
+                                       0x03, 0x80, 0x00, 0x2A, 0x22, 0xF7, 0xAA};
+        CHECK(geotiv::detail::packBitsEncode(raw.data(), raw.size()) == packed);
+
+        // Runs longer than 128 bytes are split, literals never exceed 128 bytes
+        std::vector<uint8_t> run(300, 7);
+        CHECK(geotiv::detail::packBitsEncode(run.data(), run.size()) ==
+              std::vector<uint8_t>{0x81, 7, 0x81, 7, 0xD5, 7});
+        std::vector<uint8_t> ramp(200);
+        for (size_t i = 0; i < ramp.size(); ++i)
+            ramp[i] = uint8_t(i);
+        auto lit = geotiv::detail::packBitsEncode(ramp.data(), ramp.size());
+        CHECK(lit.size() == 202);
+        CHECK(lit[0] == 127);
+        CHECK(lit[129] == 71);
+    }
+
+    SUBCASE("LZW starts with Clear and ends with End of Information") {
+        std::vector<uint8_t> raw(10000);
+        for (size_t i = 0; i < raw.size(); ++i)
+            raw[i] = uint8_t((i / 50) % 4);
+        auto lzw = geotiv::detail::lzwEncode(raw.data(), raw.size());
+        CHECK(lzw.size() < raw.size() / 10);
+        CHECK(lzw[0] == 0x80); // 9-bit Clear code (256), MSB first
+
+        auto empty = geotiv::detail::lzwEncode(nullptr, 0);
+        CHECK(empty == std::vector<uint8_t>{0x80, 0x40, 0x40}); // Clear, End (257) at 9 bits
+    }
+
+    SUBCASE("Incompressible blocks stay within encodeBound") {
+        // The writer places compressed blocks at these bounds before they are encoded
+        std::vector<uint8_t> noise(70000);
+        uint32_t x = 12345;
+        for (auto &b : noise) {
+            x = x * 1664525u + 1013904223u;
+            b = uint8_t(x >> 24);
+        }
+        for (auto codec : {geotiv::Compression::PackBits, geotiv::Compression::LZW, geotiv::Compression::Deflate}) {
+            if (!geotiv::compressionAvailable(codec))
+                continue;
+            for (size_t n : {size_t(0), size_t(1), size_t(127), size_t(4096), noise.size()}) {
+                auto encoded = geotiv::detail::encodeBlock(codec, noise.data(), n);
+                CHECK(encoded.size() <= geotiv::detail::encodeBound(codec, n));
+            }
+        }
+    }
+
+    SUBCASE("Each codec shrinks run-heavy layers and is recorded per layer") {
+        auto plain = geotiv::toTiffBytes(makeRuns(300, 400, geotiv::Compression::None));
+        for (auto codec : {geotiv::Compression::PackBits, geotiv::Compression::LZW, geotiv::Compression::Deflate}) {
+            if (!geotiv::compressionAvailable(codec)) {
+                CHECK_THROWS_AS(geotiv::toTiffBytes(makeRuns(8, 8, codec)), std::runtime_error);
+                continue;
+            }
+            for (uint32_t tileSize : {0u, 64u}) {
+                geotiv::WriteOptions opts;
+                opts.tileSize = tileSize;
+                opts.rowsPerStrip = 32;
+                opts.threads = 4;
+                auto bytes = geotiv::toTiffBytes(makeRuns(300, 400, codec), opts);
+                CHECK(bytes.size() * 3 < plain.size());
+
+                auto tags = firstIFD(bytes);
+                CHECK(tags[259] == uint16_t(codec));
+
+                // Threads only change who encodes, never the bytes
+                opts.threads = 1;
+                CHECK(geotiv::toTiffBytes(makeRuns(300, 400, codec), opts) == bytes);
+            }
+        }
+    }
+
+    SUBCASE("Compressed and plain layers mix in one file") {
+        auto rc = makeRuns(64, 64, geotiv::Compression::PackBits);
+        auto second = makeRuns(64, 64, geotiv::Compression::None);
+        rc.layers.push_back(std::move(second.layers[0]));
+
+        std::string file = "compression_mixed.tif";
+        geotiv::WriteRasterCollection(rc, file);
+        std::ifstream in(file, std::ios::binary);
+        std::vector<uint8_t> onDisk((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        CHECK(onDisk == geotiv::toTiffBytes(rc));
+
+        auto meta = geotiv::ReadRasterMetadata(file);
+        REQUIRE(meta.layers.size() == 2);
+        CHECK(meta.layers[0].stripByteCounts[0] < 64 * 64);
+        CHECK(meta.layers[1].stripByteCounts[0] == 64 * 64);
+        std::filesystem::remove(file);
+    }
+}
+
+namespace {
+    template <typename T> geotiv::RasterCollection makeTyped(size_t rows, size_t cols, geotiv::Compression compression) {
+        if constexpr (std::is_same_v<T, uint8_t>)
+            return makeRuns(rows, cols, compression);
+        auto valueAt = [](size_t r, size_t c) { return runAt(r, c) * 1000.5 + (r % 17 == 3 ? c : 0); };
+        return collectionOf({makeLayer<T>(rows, cols, valueAt, compression)});
+    }
+
+    template <typename T> void checkCodecRoundTrip(geotiv::Compression codec) {
+        const size_t rows = 150, cols = 203;
+        geotiv::RasterCollection rc = makeTyped<T>(rows, cols, codec);
+        const auto &expected = rc.layers[0].gridAs<T>();
+        for (uint32_t tileSize : {0u, 32u}) {
+            geotiv::WriteOptions wopts;
+            wopts.tileSize = tileSize;
+            wopts.rowsPerStrip = 16;
+            std::string file = "compression_roundtrip.tif";
+            geotiv::WriteRasterCollection(rc, file, wopts);
+
+            for (unsigned threads : {1u, 4u}) {
+                geotiv::ReadOptions opts;
+                opts.backend = geotiv::ReadBackend::Pread;
+                opts.threads = threads;
+                auto back = geotiv::ReadRasterCollection(file, opts);
+                CHECK(back.layers[0].compression == codec);
+                const auto &g = back.layers[0].gridAs<T>();
+                bool same = true;
+                for (size_t r = 0; r < rows; ++r)
+                    for (size_t c = 0; c < cols; ++c)
+                        same = same && g(r, c) == expected(r, c);
+                CHECK(same);
+            }
+
+            auto win = geotiv::ReadWindow(file, 0, 20, 33, 50, 70);
+            bool same = true;
+            for (size_t r = 0; r < 50; ++r)
+                for (size_t c = 0; c < 70; ++c)
+                    same = same && win.gridAs<T>()(r, c) == expected(20 + r, 33 + c);
+            CHECK(same);
+
+            // Lazy layers are decompressed on materialize and re-encoded identically on write
+            geotiv::ReadOptions lazy;
+            lazy.lazy = true;
+            CHECK(geotiv::toTiffBytes(geotiv::ReadRasterCollection(file, lazy), wopts) == geotiv::toTiffBytes(rc, wopts));
+            std::filesystem::remove(file);
+        }
+    }
+} // namespace
+
+TEST_CASE("Compressed reading") {
+    SUBCASE("Codecs decode their reference streams") {
+        std::vector<uint8_t> raw = {0xAA, 0xAA, 0xAA, 0x80, 0x00, 0x2A, 0xAA, 0xAA, 0xAA, 0xAA, 0x80, 0x00,
+                                    0x2A, 0x22, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA};
+        std::vector<uint8_t> packed = {0xFE, 0xAA, 0x02, 0x80, 0x00, 0x2A, 0xFD, 0xAA,
+                                       0x03, 0x80, 0x00, 0x2A, 0x22, 0xF7, 0xAA};
+        std::vector<uint8_t> out(raw.size());
+        geotiv::detail::packBitsDecode(packed.data(), packed.size(), out.data(), out.size());
+        CHECK(out == raw);
+        CHECK_THROWS_AS(geotiv::detail::packBitsDecode(packed.data(), 5, out.data(), out.size()), std::runtime_error);
+
+        // "AAAA" is Clear, 'A', <AA>, 'A', End as 9-bit codes
+        std::vector<uint8_t> lzw = {0x80, 0x10, 0x60, 0x44, 0x18, 0x08};
+        std::vector<uint8_t> four = {'A', 'A', 'A', 'A'};
+        CHECK(geotiv::detail::lzwEncode(four.data(), four.size()) == lzw);
+        std::vector<uint8_t> decoded(4);
+        geotiv::detail::lzwDecode(lzw.data(), lzw.size(), decoded.data(), decoded.size());
+        CHECK(decoded == four);
+    }
+
+    SUBCASE("LZW survives code width changes and table resets") {
+        // Pseudo-random bytes with some structure fill the 4094-entry table many times over
+        std::vector<uint8_t> raw(300000);
+        uint32_t x = 12345;
+        for (size_t i = 0; i < raw.size(); ++i) {
+            x = x * 1103515245u + 12345u;
+            raw[i] = (i / 700) % 2 ? uint8_t(x >> 24) : uint8_t((x >> 28) & 3);
+        }
+        auto lzw = geotiv::detail::lzwEncode(raw.data(), raw.size());
+        std::vector<uint8_t> back(raw.size());
+        geotiv::detail::lzwDecode(lzw.data(), lzw.size(), back.data(), back.size());
+        CHECK(back == raw);
+
+        std::vector<uint8_t> tooLong(raw.size() + 1);
+        CHECK_THROWS_AS(geotiv::detail::lzwDecode(lzw.data(), lzw.size(), tooLong.data(), tooLong.size()),
+                        std::runtime_error);
+    }
+
+    SUBCASE("Compressed files round trip for every codec, layout and sample type") {
+        for (auto codec : {geotiv::Compression::PackBits, geotiv::Compression::LZW, geotiv::Compression::Deflate}) {
+            if (!geotiv::compressionAvailable(codec))
+                continue;
+            checkCodecRoundTrip<uint8_t>(codec);
+            checkCodecRoundTrip<uint16_t>(codec);
+            checkCodecRoundTrip<float>(codec);
+        }
+    }
+
+    SUBCASE("Unknown codecs keep metadata readable and fail on decode") {
+        auto bytes = geotiv::toTiffBytes(makeRuns(16, 16, geotiv::Compression::None));
+        size_t ifd = bytes[4] | bytes[5] << 8;
+        for (size_t e = ifd + 2; e < ifd + 2 + 12 * size_t(bytes[ifd]); e += 12) {
+            if ((bytes[e] | bytes[e + 1] << 8) == 259)
+                bytes[e + 8] = 7; // JPEG
+        }
+        std::string file = "compression_jpeg.tif";
+        writeBytes(file, bytes);
+        auto meta = geotiv::ReadRasterMetadata(file);
+        CHECK(uint16_t(meta.layers[0].compression) == 7);
+        CHECK_THROWS_AS(geotiv::ReadRasterCollection(file), std::runtime_error);
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("Truncated compressed strips are rejected") {
+        geotiv::WriteOptions opts;
+        opts.rowsPerStrip = 8;
+        auto rc = makeRuns(64, 64, geotiv::Compression::LZW);
+        std::string file = "compression_truncated.tif";
+        geotiv::WriteRasterCollection(rc, file, opts);
+        auto meta = geotiv::ReadRasterMetadata(file);
+
+        // Shorten the last strip's byte count: its data now ends before End of Information
+        auto bytes = geotiv::toTiffBytes(rc, opts);
+        uint64_t last = meta.layers[0].stripByteCounts.back();
+        for (size_t at = 8; at + 4 <= bytes.size(); ++at) {
+            uint32_t v = bytes[at] | bytes[at + 1] << 8 | bytes[at + 2] << 16 | uint32_t(bytes[at + 3]) << 24;
+            if (v == last && at > meta.layers[0].stripOffsets.back() + last) {
+                bytes[at] = uint8_t(last / 4);
+                bytes[at + 1] = bytes[at + 2] = bytes[at + 3] = 0;
+                break;
+            }
+        }
+        writeBytes(file, bytes);
+        CHECK_THROWS_AS(geotiv::ReadRasterCollection(file), std::runtime_error);
+        std::filesystem::remove(file);
+    }
+}
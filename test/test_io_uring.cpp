@@ -0,0 +1,151 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#if GEOTIV_HAS_IO_URING
+#include <fcntl.h>
+#endif
+
+using namespace helpers;
+
+namespace {
+    int32_t valueAt(size_t r, size_t c) { return int32_t(r * 1000 + c) - 50000; }
+
+    geotiv::RasterCollection makeCollection(geotiv::Compression compression) {
+        std::vector<geotiv::Layer> layers;
+        for (size_t i = 0; i < 3; ++i)
+            layers.push_back(makeLayer<int32_t>(120 + 9 * i, 97, valueAt, compression));
+        return collectionOf(std::move(layers));
+    }
+
+#if GEOTIV_HAS_IO_URING
+    // A ring whose io_uring_enter fails with EIO after the first okCalls calls
+    struct FailingRing : geotiv::detail::IoRing {
+        int calls = 0, okCalls;
+        FailingRing(unsigned depth, int okCalls) : IoRing(depth), okCalls(okCalls) {}
+        int enter(unsigned submit, unsigned wait) override {
+            return ++calls > okCalls ? -EIO : IoRing::enter(submit, wait);
+        }
+    };
+#endif
+} // namespace
+
+TEST_CASE("io_uring reads") {
+    SUBCASE("Batches complete every request once, short at the end of the file") {
+        std::string file = "uring_bytes.bin";
+        std::vector<uint8_t> bytes(100000);
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = uint8_t(i * 7 + i / 251);
+        writeBytes(file, bytes);
+
+        auto src = geotiv::openByteSource(file, geotiv::ReadOptions{geotiv::ReadBackend::IoUring});
+        std::mt19937 rng(3);
+        std::vector<geotiv::ReadRequest> requests(300); // more than a ring holds
+        std::vector<std::vector<uint8_t>> buffers(requests.size());
+        for (size_t i = 0; i < requests.size(); ++i) {
+            buffers[i].resize(1 + rng() % 3000);
+            requests[i] = {rng() % bytes.size(), buffers[i].data(), buffers[i].size()};
+        }
+        std::vector<int> seen(requests.size(), 0);
+        bool contentOk = true;
+        src->readBatch(requests, [&](size_t i, size_t got) {
+            ++seen[i];
+            size_t expected = std::min<size_t>(requests[i].n, bytes.size() - requests[i].offset);
+            contentOk &= got == expected &&
+                         std::equal(buffers[i].begin(), buffers[i].begin() + got, bytes.begin() + requests[i].offset);
+        });
+        CHECK(contentOk);
+        CHECK(std::count(seen.begin(), seen.end(), 1) == int(seen.size()));
+
+        // An exception from the callback surfaces once the reads in flight are done; the source stays usable
+        CHECK_THROWS_AS(src->readBatch(requests, [](size_t i, size_t) {
+            if (i == 5)
+                throw std::runtime_error("stop");
+        }),
+                        std::runtime_error);
+        size_t completed = 0;
+        src->readBatch(requests, [&](size_t, size_t) { ++completed; });
+        CHECK(completed == requests.size());
+        std::filesystem::remove(file);
+    }
+
+#if GEOTIV_HAS_IO_URING
+    SUBCASE("A failing io_uring_enter drains the reads in flight and finishes the batch with pread") {
+        std::string file = "uring_failing.bin";
+        std::vector<uint8_t> bytes(50000);
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = uint8_t(i * 13 + i / 97);
+        writeBytes(file, bytes);
+        int fd = ::open(file.c_str(), O_RDONLY);
+        REQUIRE(fd >= 0);
+
+        for (int okCalls : {0, 1, 3}) {
+            FailingRing ring(4, okCalls);
+            if (!ring.ok())
+                break; // no io_uring in this kernel
+            std::vector<geotiv::ReadRequest> requests(40);
+            std::vector<std::vector<uint8_t>> buffers(requests.size());
+            for (size_t i = 0; i < requests.size(); ++i) {
+                buffers[i].resize(1000);
+                requests[i] = {i * 1200, buffers[i].data(), buffers[i].size()};
+            }
+            std::vector<int> seen(requests.size(), 0);
+            bool contentOk = true;
+            ring.readAll(fd, requests, [&](size_t i, size_t got) {
+                ++seen[i];
+                contentOk &= got == 1000 && std::equal(buffers[i].begin(), buffers[i].end(),
+                                                       bytes.begin() + requests[i].offset);
+            });
+            CHECK(contentOk);
+            CHECK(std::count(seen.begin(), seen.end(), 1) == int(seen.size()));
+            CHECK_FALSE(ring.ok());
+        }
+        ::close(fd);
+        std::filesystem::remove(file);
+    }
+#endif
+
+    SUBCASE("Layers and windows read the same as with pread") {
+        for (auto compression : {geotiv::Compression::None, geotiv::Compression::LZW}) {
+            auto rc = makeCollection(compression);
+            for (uint32_t tileSize : {0u, 16u}) {
+                geotiv::WriteOptions opts;
+                opts.tileSize = tileSize;
+                opts.rowsPerStrip = 4;
+                std::string file = "uring_layers.tif";
+                geotiv::WriteRasterCollection(rc, file, opts);
+
+                for (unsigned threads : {1u, 4u}) {
+                    geotiv::ReadOptions uring{geotiv::ReadBackend::IoUring};
+                    uring.threads = threads;
+                    auto back = geotiv::ReadRasterCollection(file, uring);
+                    REQUIRE(back.layers.size() == 3);
+                    for (auto const &L : back.layers)
+                        CHECK(matches(L.gridAs<int32_t>(), 0, 0, valueAt));
+
+                    // Narrow windows of stored strips are one read per row, all in one batch
+                    auto win = geotiv::ReadWindow(file, 2, 13, 20, 70, 9, uring);
+                    CHECK(matches(win.gridAs<int32_t>(), 13, 20, valueAt));
+
+                    uring.lazy = true;
+                    CHECK(geotiv::toTiffBytes(geotiv::ReadRasterCollection(file, uring), opts) ==
+                          geotiv::toTiffBytes(rc, opts));
+                }
+                std::filesystem::remove(file);
+            }
+        }
+    }
+
+    SUBCASE("Truncated files fail like the other backends") {
+        std::string file = "uring_truncated.tif";
+        auto bytes = geotiv::toTiffBytes(makeCollection(geotiv::Compression::None));
+        bytes.resize(bytes.size() - 500);
+        writeBytes(file, bytes);
+        CHECK_THROWS_AS(geotiv::ReadRasterCollection(file, geotiv::ReadOptions{geotiv::ReadBackend::IoUring}),
+                        std::runtime_error);
+        std::filesystem::remove(file);
+    }
+}
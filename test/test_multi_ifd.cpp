@@ -197,4 +197,63 @@ TEST_CASE("Advanced Multi-IFD with Per-Layer Tags and Metadata") {
         // Clean up
         std::filesystem::remove(timeSeriesFile);
     }
+
+    SUBCASE("Layers decoded in parallel keep file order and content") {
+        geotiv::RasterCollection rc;
+        for (int i = 0; i < 7; ++i) {
+            size_t rows = 20 + i * 3, cols = 25 + i;
+            concord::Datum datum{47.0 + i * 0.1, 8.0, 100.0};
+            concord::Pose shift{concord::Point{double(i), 0, 0}, concord::Euler{0, 0, 0}};
+            concord::Grid<uint8_t> grid(rows, cols, 1.0, true, shift);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    grid(r, c) = static_cast<uint8_t>((i * 37 + r * 2 + c) % 256);
+                }
+            }
+
+            geotiv::Layer layer;
+            layer.grid = std::move(grid);
+            layer.width = static_cast<uint32_t>(cols);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = 1;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            layer.resolution = 1.0;
+            layer.customTags[50000] = {static_cast<uint32_t>(i)};
+            rc.layers.push_back(std::move(layer));
+        }
+
+        std::string testFile = "multi_ifd_parallel.tif";
+        geotiv::WriteOptions writeOpts;
+        writeOpts.rowsPerStrip = 4;
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile, writeOpts));
+
+        auto sequential = geotiv::ReadRasterCollection(testFile);
+        for (unsigned threads : {2u, 3u, 16u}) {
+            geotiv::ReadOptions opts;
+            opts.backend = geotiv::ReadBackend::Mmap;
+            opts.threads = threads;
+            auto parallel = geotiv::ReadRasterCollection(testFile, opts);
+            REQUIRE(parallel.layers.size() == 7);
+            CHECK(parallel.datum.lat == doctest::Approx(sequential.datum.lat));
+            for (size_t i = 0; i < 7; ++i) {
+                const auto &a = sequential.layers[i];
+                const auto &b = parallel.layers[i];
+                CHECK(a.ifdOffset == b.ifdOffset);
+                CHECK(b.customTags.at(50000)[0] == i);
+                CHECK(b.shift.point.x == doctest::Approx(double(i)));
+                REQUIRE(b.grid.rows() == a.grid.rows());
+                bool same = true;
+                for (size_t r = 0; r < a.grid.rows(); ++r) {
+                    for (size_t c = 0; c < a.grid.cols(); ++c) {
+                        same = same && a.grid(r, c) == b.grid(r, c);
+                    }
+                }
+                CHECK(same);
+            }
+        }
+
+        std::filesystem::remove(testFile);
+    }
 }
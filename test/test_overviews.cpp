@@ -0,0 +1,221 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <random>
+
+using namespace helpers;
+
+namespace {
+    template <typename T> T valueAt(size_t r, size_t c) {
+        if constexpr (std::is_floating_point_v<T>)
+            return T(r * 1.25 + c * 0.5);
+        else
+            return T((r / 3 + c / 5) % 7); // blocky classes
+    }
+
+    template <typename T>
+    geotiv::Layer pyramidLayer(size_t rows, size_t cols, geotiv::Resampling resampling,
+                               geotiv::Compression compression = geotiv::Compression::None) {
+        auto layer = makeLayer<T>(rows, cols, valueAt<T>, compression);
+        layer.overviewResampling = resampling;
+        return layer;
+    }
+
+    // Pixels of an overview IFD, which ReadRasterCollection keeps as metadata only
+    template <typename T> concord::Grid<T> overviewPixels(const std::string &file, const geotiv::Layer &ov) {
+        auto src = geotiv::detail::openSource(file, {});
+        geotiv::detail::Cursor f(*src);
+        geotiv::detail::TIFFFile t{f};
+        geotiv::detail::readHeader(t);
+        return std::get<concord::Grid<T>>(geotiv::detail::decodeLayerPixels(t, ov));
+    }
+
+    template <typename T> void checkRowKernel(geotiv::Resampling m) {
+        std::mt19937 rng(7);
+        for (size_t cols : {1u, 2u, 7u, 31u, 32u, 33u, 100u}) {
+            std::vector<T> a(cols), b(cols), out((cols + 1) / 2);
+            for (size_t c = 0; c < cols; ++c) {
+                a[c] = T(rng() % 200);
+                b[c] = T(rng() % 200);
+            }
+            geotiv::detail::reduceRow(m, a.data(), b.data(), cols, out.data());
+            for (size_t c = 0; c < out.size(); ++c) {
+                size_t c1 = std::min(2 * c + 1, cols - 1);
+                CHECK(out[c] == geotiv::detail::reduceBlock(m, a[2 * c], a[c1], b[2 * c], b[c1]));
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("Overviews") {
+    using geotiv::Resampling;
+
+    SUBCASE("2x2 reductions") {
+        CHECK(geotiv::detail::reduceBlock<uint8_t>(Resampling::Mean, 1, 2, 3, 4) == 3); // 2.5 rounds up
+        CHECK(geotiv::detail::reduceBlock<int16_t>(Resampling::Mean, -1, -2, -2, -2) == -2);
+        CHECK(geotiv::detail::reduceBlock<float>(Resampling::Mean, 1, 2, 3, 4) == 2.5f);
+        CHECK(geotiv::detail::reduceBlock<uint8_t>(Resampling::Max, 9, 200, 3, 4) == 200);
+        CHECK(geotiv::detail::reduceBlock<uint8_t>(Resampling::Mode, 5, 7, 9, 7) == 7);
+        CHECK(geotiv::detail::reduceBlock<uint8_t>(Resampling::Mode, 5, 7, 7, 5) == 5); // tie: first wins
+        CHECK(geotiv::detail::reduceBlock<uint8_t>(Resampling::Mode, 1, 2, 3, 4) == 1);
+    }
+
+    SUBCASE("Vectorized rows match the 2x2 kernel") {
+        for (auto m : {Resampling::Mean, Resampling::Max, Resampling::Mode}) {
+            checkRowKernel<uint8_t>(m);
+            checkRowKernel<float>(m);
+            checkRowKernel<int16_t>(m);
+        }
+    }
+
+    SUBCASE("Odd sizes round up and repeat their last row and column") {
+        concord::Grid<uint8_t> g(5, 3, 1.0, true, shift);
+        for (size_t r = 0; r < 5; ++r)
+            for (size_t c = 0; c < 3; ++c)
+                g(r, c) = uint8_t(r * 10 + c);
+        auto half = geotiv::detail::downsample(g, Resampling::Max, 2.0, shift, 4);
+        REQUIRE(half.rows() == 3);
+        REQUIRE(half.cols() == 2);
+        CHECK(half(0, 0) == 11);
+        CHECK(half(0, 1) == 12);
+        CHECK(half(2, 0) == 41);
+        CHECK(half(2, 1) == 42);
+    }
+
+    SUBCASE("Overview IFDs are written after their layer and read back as its overviews") {
+        auto rc = collectionOf({pyramidLayer<float>(100, 70, Resampling::Mean, geotiv::Compression::LZW),
+                                pyramidLayer<uint8_t>(40, 40, Resampling::Mode)});
+        geotiv::WriteOptions opts;
+        opts.tileSize = 16;
+        opts.overviewLevels = 5;
+        std::string file = "overviews.tif";
+        geotiv::WriteRasterCollection(rc, file, opts);
+
+        auto back = geotiv::ReadRasterCollection(file);
+        REQUIRE(back.layers.size() == 2);
+        auto const &elevation = back.layers[0];
+        CHECK(elevation.subfileType == 0);
+        CHECK(elevation.gridAs<float>()(99, 69) == valueAt<float>(99, 69));
+        // 50x35, 25x18, 13x9: the last one fits in a 16-pixel tile, so no fourth level
+        REQUIRE(elevation.overviews.size() == 3);
+        CHECK(elevation.overviews[0].width == 35);
+        CHECK(elevation.overviews[0].height == 50);
+        CHECK(elevation.overviews[2].width == 9);
+        CHECK(elevation.overviews[2].height == 13);
+        CHECK(elevation.overviews[1].subfileType == 1);
+        CHECK(elevation.overviews[1].resolution == doctest::Approx(2.0));
+        CHECK(elevation.overviews[1].compression == geotiv::Compression::LZW);
+        CHECK(back.layers[1].overviews.size() == 2); // 20x20, 10x10
+
+        auto level1 = overviewPixels<float>(file, elevation.overviews[0]);
+        float expected = ((valueAt<float>(2, 4) + valueAt<float>(3, 4)) + (valueAt<float>(2, 5) + valueAt<float>(3, 5))) *
+                         0.25f;
+        CHECK(level1(1, 2) == expected);
+        auto classes = overviewPixels<uint8_t>(file, back.layers[1].overviews[0]);
+        CHECK(classes(4, 3) == valueAt<uint8_t>(8, 6));
+
+        // Windows address layers, not overview IFDs
+        auto win = geotiv::ReadWindow(file, 1, 0, 0, 4, 4);
+        CHECK(win.sampleType == geotiv::SampleType::UInt8);
+
+        geotiv::ReadOptions parallel{geotiv::ReadBackend::Pread};
+        parallel.threads = 4;
+        auto threaded = geotiv::ReadRasterCollection(file, parallel);
+        REQUIRE(threaded.layers.size() == 2);
+        CHECK(threaded.layers[0].overviews.size() == 3);
+        CHECK(geotiv::ReadRasterMetadata(file).layers[1].overviews.size() == 2);
+
+        // Levels are built while writing, from lazy layers as well, in either layout
+        geotiv::ReadOptions lazyOpts;
+        lazyOpts.lazy = true;
+        auto lazy = geotiv::ReadRasterCollection(file, lazyOpts);
+        back.layers[1].overviewResampling = lazy.layers[1].overviewResampling = Resampling::Mode;
+        for (bool cog : {false, true}) {
+            opts.cloudOptimized = cog;
+            CHECK(geotiv::toTiffBytes(lazy, opts) == geotiv::toTiffBytes(back, opts));
+        }
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("Thread count does not change the file, and COG puts the smallest overview first") {
+        auto rc = collectionOf({pyramidLayer<uint8_t>(200, 150, Resampling::Mean)});
+        geotiv::WriteOptions opts;
+        opts.tileSize = 32;
+        opts.overviewLevels = 3;
+        auto serial = geotiv::toTiffBytes(rc, opts);
+        opts.threads = 4;
+        CHECK(geotiv::toTiffBytes(rc, opts) == serial);
+
+        opts.cloudOptimized = true;
+        std::string file = "overviews_cog.tif";
+        geotiv::WriteRasterCollection(rc, file, opts);
+        auto meta = geotiv::ReadRasterMetadata(file);
+        REQUIRE(meta.layers[0].overviews.size() == 3);
+        auto const &full = meta.layers[0];
+        CHECK(full.overviews[2].tileOffsets.front() < full.overviews[1].tileOffsets.front());
+        CHECK(full.overviews[1].tileOffsets.front() < full.overviews[0].tileOffsets.front());
+        CHECK(full.overviews[0].tileOffsets.front() < full.tileOffsets.front());
+        CHECK(full.overviews[0].ifdOffset < full.overviews[2].tileOffsets.front());
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("A target resolution reads the coarsest level that still meets it") {
+        auto rc = collectionOf({pyramidLayer<float>(100, 70, Resampling::Mean, geotiv::Compression::LZW)});
+        geotiv::WriteOptions opts;
+        opts.tileSize = 16;
+        opts.overviewLevels = 5; // 0.5 m, then 1, 2 and 4 m per pixel
+        std::string file = "overviews_target.tif";
+        geotiv::WriteRasterCollection(rc, file, opts);
+        auto all = geotiv::ReadRasterMetadata(file);
+        REQUIRE(all.layers[0].overviews.size() == 3);
+
+        geotiv::ReadOptions target;
+        target.targetResolution = 1.5;
+        auto level1 = geotiv::ReadRasterCollection(file, target);
+        auto const &L = level1.layers[0];
+        REQUIRE(L.width == 35);
+        REQUIRE(L.height == 50);
+        CHECK(L.subfileType == 0);
+        CHECK(L.resolution == doctest::Approx(1.0));
+        CHECK(level1.resolution == doctest::Approx(1.0));
+        CHECK(L.datum.lat == doctest::Approx(datum.lat));
+        REQUIRE(L.overviews.size() == 2); // only the levels coarser than the one picked
+        CHECK(L.overviews[0].width == 18);
+        CHECK(L.overviews[1].width == 9);
+        auto expected = overviewPixels<float>(file, all.layers[0].overviews[0]);
+        CHECK(L.gridAs<float>()(10, 20) == expected(10, 20));
+        CHECK(L.gridAs<float>()(49, 34) == expected(49, 34));
+
+        target.targetResolution = 100;
+        auto coarsest = geotiv::ReadRasterMetadata(file, target).layers[0];
+        CHECK(coarsest.width == 9);
+        CHECK(coarsest.overviews.empty());
+        target.targetResolution = 0.3; // finer than the file: full resolution
+        CHECK(geotiv::ReadRasterCollection(file, target).layers[0].width == 70);
+
+        target.targetResolution = 2;
+        target.lazy = true;
+        auto lazy = geotiv::ReadRasterCollection(file, target);
+        REQUIRE(lazy.layers[0].height == 25);
+        REQUIRE(lazy.layers[0].overviews.size() == 1);
+        CHECK(lazy.layers[0].overviews[0].width == 9);
+        CHECK(lazy.layers[0].overviews[0].height == 13);
+        CHECK(lazy.layers[0].gridAs<float>()(7, 3) ==
+              overviewPixels<float>(file, all.layers[0].overviews[1])(7, 3));
+
+        // Windows are given in full-resolution pixels and widen to whole pixels of the level
+        target.lazy = false;
+        target.targetResolution = 1;
+        auto win = geotiv::ReadWindow(file, 0, 11, 20, 30, 9, target);
+        CHECK(win.height == 16); // rows 5..20 of the 1 m level
+        CHECK(win.width == 5);   // columns 10..14
+        CHECK(win.resolution == doctest::Approx(1.0));
+        CHECK(win.overviews.empty());
+        CHECK(win.gridAs<float>()(0, 0) == expected(5, 10));
+        CHECK(win.gridAs<float>()(15, 4) == expected(20, 14));
+        CHECK_THROWS_AS(geotiv::ReadWindow(file, 0, 90, 0, 20, 4, target), std::out_of_range);
+        std::filesystem::remove(file);
+    }
+}
@@ -241,4 +241,412 @@ TEST_CASE("GeoTIFF Parser functionality") {
         // Clean up
         std::filesystem::remove(testFile);
     }
+
+    SUBCASE("Mmap backend matches stream backend") {
+        size_t rows = 7, cols = 9;
+        double cellSize = 0.5;
+        concord::Datum datum{46.5, 6.6, 372.0};
+        concord::Pose shift{concord::Point{10, -5, 0}, concord::Euler{0, 0, 0.2}};
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = cellSize;
+
+        for (int layerIdx = 0; layerIdx < 3; ++layerIdx) {
+            concord::Grid<uint8_t> grid(rows, cols, cellSize, true, shift);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    grid(r, c) = static_cast<uint8_t>(layerIdx * 60 + r * cols + c);
+                }
+            }
+
+            geotiv::Layer layer;
+            layer.grid = std::move(grid);
+            layer.width = static_cast<uint32_t>(cols);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = 1;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            layer.resolution = cellSize;
+            layer.customTags[50000] = {static_cast<uint32_t>(layerIdx), 7u, 9u};
+            rc.layers.push_back(std::move(layer));
+        }
+
+        std::string testFile = "mmap_backend.tif";
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile));
+
+        auto viaStream = geotiv::ReadRasterCollection(testFile);
+        for (auto access :
+             {geotiv::AccessPattern::Normal, geotiv::AccessPattern::Sequential, geotiv::AccessPattern::Random}) {
+            geotiv::ReadOptions opts;
+            opts.backend = geotiv::ReadBackend::Mmap;
+            opts.access = access;
+            auto viaMmap = geotiv::ReadRasterCollection(testFile, opts);
+
+            REQUIRE(viaMmap.layers.size() == viaStream.layers.size());
+            for (size_t i = 0; i < viaStream.layers.size(); ++i) {
+                const auto &a = viaStream.layers[i];
+                const auto &b = viaMmap.layers[i];
+                CHECK(a.ifdOffset == b.ifdOffset);
+                CHECK(a.width == b.width);
+                CHECK(a.height == b.height);
+                CHECK(a.imageDescription == b.imageDescription);
+                CHECK(a.customTags == b.customTags);
+                CHECK(a.resolution == b.resolution);
+                bool samePixels = true;
+                for (size_t r = 0; r < rows; ++r) {
+                    for (size_t c = 0; c < cols; ++c) {
+                        samePixels = samePixels && a.grid(r, c) == b.grid(r, c);
+                    }
+                }
+                CHECK(samePixels);
+            }
+        }
+
+        geotiv::ReadOptions mmapOpts;
+        mmapOpts.backend = geotiv::ReadBackend::Mmap;
+        CHECK_THROWS(geotiv::ReadRasterCollection("non_existent_file.tif", mmapOpts));
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Metadata-only scan never reads strips") {
+        size_t rows = 6, cols = 8;
+        concord::Datum datum{52.0, 5.0, 10.0};
+        concord::Pose shift{concord::Point{3, 4, 0}, concord::Euler{0, 0, 0.1}};
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 0.25;
+        for (int layerIdx = 0; layerIdx < 2; ++layerIdx) {
+            geotiv::Layer layer;
+            layer.grid = concord::Grid<uint8_t>(rows, cols + layerIdx, 0.25, true, shift);
+            layer.width = static_cast<uint32_t>(cols + layerIdx);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = 1;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            layer.resolution = 0.25 * (layerIdx + 1);
+            layer.customTags[50001] = {static_cast<uint32_t>(layerIdx + 100)};
+            rc.layers.push_back(std::move(layer));
+        }
+
+        auto bytes = geotiv::toTiffBytes(rc);
+
+        // Point every StripOffsets entry past the end of the file: pixel reads must fail, metadata must not
+        auto rd16 = [&](size_t o) { return uint16_t(bytes[o] | (bytes[o + 1] << 8)); };
+        auto rd32 = [&](size_t o) { return uint32_t(rd16(o)) | (uint32_t(rd16(o + 2)) << 16); };
+        for (uint32_t ifd = rd32(4); ifd != 0;) {
+            uint16_t n = rd16(ifd);
+            for (uint16_t i = 0; i < n; ++i) {
+                size_t e = ifd + 2 + i * 12;
+                if (rd16(e) == 273) {
+                    uint32_t bogus = 0x7FFFFFF0;
+                    std::memcpy(&bytes[e + 8], &bogus, 4);
+                }
+            }
+            ifd = rd32(ifd + 2 + n * 12);
+        }
+
+        std::string testFile = "metadata_only.tif";
+        {
+            std::ofstream ofs(testFile, std::ios::binary);
+            ofs.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        }
+
+        CHECK_THROWS(geotiv::ReadRasterCollection(testFile));
+
+        geotiv::RasterCollection meta;
+        REQUIRE_NOTHROW(meta = geotiv::ReadRasterMetadata(testFile));
+        REQUIRE(meta.layers.size() == 2);
+        CHECK(meta.datum.lat == doctest::Approx(datum.lat).epsilon(0.001));
+        CHECK(meta.resolution == doctest::Approx(0.25));
+        for (size_t i = 0; i < 2; ++i) {
+            const auto &L = meta.layers[i];
+            CHECK(L.width == cols + i);
+            CHECK(L.height == rows);
+            CHECK(L.resolution == doctest::Approx(0.25 * (i + 1)));
+            CHECK(L.shift.point.x == doctest::Approx(3.0));
+            CHECK(L.customTags.at(50001)[0] == 100 + i);
+            CHECK(L.stripOffsets.size() == 1);
+            CHECK(L.grid.rows() == 0);
+        }
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Lazy read defers strip decoding per layer") {
+        size_t rows = 5, cols = 4;
+        concord::Datum datum{47.5, 8.5, 200.0};
+        concord::Pose shift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}};
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 1.0;
+        for (int layerIdx = 0; layerIdx < 4; ++layerIdx) {
+            concord::Grid<uint8_t> grid(rows, cols, 1.0, true, shift);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    grid(r, c) = static_cast<uint8_t>(layerIdx * 40 + r * cols + c);
+                }
+            }
+            geotiv::Layer layer;
+            layer.grid = std::move(grid);
+            layer.width = static_cast<uint32_t>(cols);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = 1;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            rc.layers.push_back(std::move(layer));
+        }
+
+        std::string testFile = "lazy_read.tif";
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile));
+
+        for (auto backend : {geotiv::ReadBackend::Stream, geotiv::ReadBackend::Mmap}) {
+            geotiv::ReadOptions opts;
+            opts.backend = backend;
+            opts.lazy = true;
+            auto lazy = geotiv::ReadRasterCollection(testFile, opts);
+
+            REQUIRE(lazy.layers.size() == 4);
+            for (const auto &L : lazy.layers) {
+                CHECK_FALSE(L.isMaterialized());
+                CHECK(L.grid.rows() == 0);
+            }
+
+            auto &g2 = lazy.layers[2].materialize();
+            CHECK(lazy.layers[2].isMaterialized());
+            CHECK(g2.rows() == rows);
+            CHECK(g2(0, 0) == 80);
+            CHECK(g2(4, 3) == 80 + 19);
+            CHECK_FALSE(lazy.layers[1].isMaterialized());
+
+            // Unmaterialized layers are decoded on the fly when written out
+            auto bytes = geotiv::toTiffBytes(lazy);
+            CHECK(bytes == geotiv::toTiffBytes(rc));
+        }
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Windowed reads match the full decode") {
+        size_t rows = 10, cols = 20;
+        concord::Datum datum{47.5, 8.5, 200.0};
+        concord::Pose shift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}};
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 1.0;
+        for (uint32_t spp : {1u, 3u}) {
+            concord::Grid<uint8_t> grid(rows, cols, 1.0, true, shift);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    grid(r, c) = static_cast<uint8_t>(spp * 7 + r * cols + c);
+                }
+            }
+            geotiv::Layer layer;
+            layer.grid = std::move(grid);
+            layer.width = static_cast<uint32_t>(cols);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = spp;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            rc.layers.push_back(std::move(layer));
+        }
+
+        std::string testFile = "window_read.tif";
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile));
+        auto full = geotiv::ReadRasterCollection(testFile);
+
+        for (size_t li = 0; li < 2; ++li) {
+            for (auto backend : {geotiv::ReadBackend::Stream, geotiv::ReadBackend::Mmap}) {
+                geotiv::ReadOptions opts;
+                opts.backend = backend;
+                opts.access = geotiv::AccessPattern::Random;
+
+                auto win = geotiv::ReadWindow(testFile, li, 3, 5, 4, 6, opts);
+                CHECK(win.width == 6);
+                CHECK(win.height == 4);
+                REQUIRE(win.grid.rows() == 4);
+                REQUIRE(win.grid.cols() == 6);
+                bool same = true;
+                for (uint32_t r = 0; r < 4; ++r) {
+                    for (uint32_t c = 0; c < 6; ++c) {
+                        same = same && win.grid(r, c) == full.layers[li].grid(3 + r, 5 + c);
+                    }
+                }
+                CHECK(same);
+
+                // Full-width window goes through the contiguous-rows path
+                auto band = geotiv::ReadWindow(testFile, li, 7, 0, 3, static_cast<uint32_t>(cols), opts);
+                CHECK(band.grid(2, 19) == full.layers[li].grid(9, 19));
+            }
+        }
+
+        // Window center moves the shift: rows run south, columns east
+        auto corner = geotiv::ReadWindow(testFile, 0, 0, 0, 2, 2);
+        CHECK(corner.shift.point.x == doctest::Approx(-9.0));
+        CHECK(corner.shift.point.y == doctest::Approx(4.0));
+
+        // ENU box [-8,-6]..[1,4] covers cols [2,6) and rows [1,4)
+        auto boxed = geotiv::ReadWindow(testFile, 0, concord::Point{-8, 1, 0}, concord::Point{-4, 4, 0});
+        CHECK(boxed.width == 4);
+        CHECK(boxed.height == 3);
+        CHECK(boxed.grid(0, 0) == full.layers[0].grid(1, 2));
+        CHECK(boxed.grid(2, 3) == full.layers[0].grid(3, 5));
+
+        CHECK_THROWS_AS(geotiv::ReadWindow(testFile, 0, 8, 0, 4, 4), std::out_of_range);
+        CHECK_THROWS_AS(geotiv::ReadWindow(testFile, 2, 0, 0, 1, 1), std::out_of_range);
+        CHECK_THROWS_AS(geotiv::ReadWindow(testFile, 0, concord::Point{100, 100, 0}, concord::Point{200, 200, 0}),
+                        std::out_of_range);
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Parallel strip and tile decoding matches a single thread") {
+        size_t rows = 120, cols = 90;
+        concord::Datum datum{47.5, 8.5, 200.0};
+        concord::Pose shift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}};
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 1.0;
+        for (uint32_t spp : {1u, 2u}) {
+            concord::Grid<uint8_t> grid(rows, cols, 1.0, true, shift);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    grid(r, c) = static_cast<uint8_t>(spp * 11 + r * 3 + c);
+                }
+            }
+            geotiv::Layer layer;
+            layer.grid = std::move(grid);
+            layer.width = static_cast<uint32_t>(cols);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = spp;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            rc.layers.push_back(std::move(layer));
+        }
+
+        std::string testFile = "parallel_read.tif";
+        geotiv::WriteOptions stripped;
+        stripped.rowsPerStrip = 8;
+        geotiv::WriteOptions tiled;
+        tiled.tileSize = 32;
+        for (const auto &writeOpts : {stripped, tiled}) {
+            REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile, writeOpts));
+            auto single = geotiv::ReadRasterCollection(testFile);
+
+            for (auto backend : {geotiv::ReadBackend::Stream, geotiv::ReadBackend::Mmap, geotiv::ReadBackend::Pread}) {
+                geotiv::ReadOptions opts;
+                opts.backend = backend;
+                opts.threads = 4;
+                auto multi = geotiv::ReadRasterCollection(testFile, opts);
+                REQUIRE(multi.layers.size() == 2);
+                for (size_t li = 0; li < 2; ++li) {
+                    bool same = true;
+                    for (size_t r = 0; r < rows; ++r) {
+                        for (size_t c = 0; c < cols; ++c) {
+                            same = same && multi.layers[li].grid(r, c) == single.layers[li].grid(r, c);
+                        }
+                    }
+                    CHECK(same);
+                }
+
+                auto win = geotiv::ReadWindow(testFile, 1, 30, 20, 50, 40, opts);
+                CHECK(win.grid(49, 39) == single.layers[1].grid(79, 59));
+            }
+        }
+
+        // Errors raised on worker threads reach the caller: truncate the tiles away behind an open lazy read
+        geotiv::ReadOptions opts;
+        opts.backend = geotiv::ReadBackend::Pread;
+        opts.threads = 0; // one per hardware thread
+        opts.lazy = true;
+        auto lazy = geotiv::ReadRasterCollection(testFile, opts);
+        std::filesystem::resize_file(testFile, 16);
+        CHECK_THROWS_AS(lazy.layers[0].materialize(), std::runtime_error);
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("IFD directory lookups tolerate unsorted and repeated tags") {
+        geotiv::detail::IFDDirectory dir;
+        for (uint16_t tag : {259, 256, 50001, 257, 256}) {
+            dir.entries.push_back({tag, 3, 1, uint64_t(tag) * 10 + dir.entries.size(), {}});
+        }
+        dir.finalize();
+        REQUIRE(dir.entries.size() == 4);
+        CHECK(std::is_sorted(dir.entries.begin(), dir.entries.end(),
+                             [](auto const &a, auto const &b) { return a.tag < b.tag; }));
+        REQUIRE(dir.find(256) != nullptr);
+        CHECK(dir.find(256)->valueOffset == 2564); // last occurrence wins
+        CHECK(dir.find(50001)->valueOffset == 500012);
+        CHECK(dir.find(258) == nullptr);
+    }
+
+    SUBCASE("IFDs larger than the read-ahead block are parsed whole") {
+        concord::Datum datum{47.5, 8.5, 200.0};
+        concord::Pose shift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}};
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 1.0;
+        for (int layerIdx = 0; layerIdx < 2; ++layerIdx) {
+            geotiv::Layer layer;
+            layer.grid = concord::Grid<uint8_t>(3, 4, 1.0, true, shift);
+            layer.grid(2, 3) = static_cast<uint8_t>(40 + layerIdx);
+            layer.width = 4;
+            layer.height = 3;
+            layer.samplesPerPixel = 1;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            layer.resolution = 1.0;
+            // 500 single-value tags: 500 * 12 bytes of entries, well past one read-ahead block
+            for (uint16_t k = 0; k < 500; ++k)
+                layer.customTags[uint16_t(50000 + k)] = {uint32_t(k * 3 + layerIdx)};
+            rc.layers.push_back(std::move(layer));
+        }
+
+        std::string testFile = "large_ifd.tif";
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile));
+        auto back = geotiv::ReadRasterCollection(testFile);
+        REQUIRE(back.layers.size() == 2);
+        for (int layerIdx = 0; layerIdx < 2; ++layerIdx) {
+            const auto &L = back.layers[layerIdx];
+            CHECK(L.customTags.size() == 500);
+            CHECK(L.customTags.at(50499) == std::vector<uint32_t>{uint32_t(499 * 3 + layerIdx)});
+            CHECK(L.grid(2, 3) == 40 + layerIdx);
+        }
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Tag arrays decode in bulk in either byte order") {
+        const uint8_t be[] = {0x01, 0x02, 0x03, 0x04, 0xFF, 0xFE};
+        uint64_t wide[3];
+        geotiv::detail::decodeWords</*Little=*/false, uint16_t>(be, 3, wide);
+        CHECK(wide[0] == 0x0102);
+        CHECK(wide[1] == 0x0304);
+        CHECK(wide[2] == 0xFFFE);
+        geotiv::detail::decodeWords</*Little=*/true, uint32_t>(be, 1, wide); // classic LONG offsets
+        CHECK(wide[0] == 0x04030201u);
+
+        uint32_t words[1];
+        geotiv::detail::decodeWords</*Little=*/true, uint32_t>(be, 1, words);
+        CHECK(words[0] == 0x04030201u);
+        geotiv::detail::decodeWords</*Little=*/false, uint32_t>(be, 1, words);
+        CHECK(words[0] == 0x01020304u);
+    }
 }
@@ -0,0 +1,157 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "geotiv/predictor.hpp"
+#include "helpers.hpp"
+#include <cmath>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <random>
+
+using namespace helpers;
+
+namespace {
+    // Smooth terrain-like surface, so predicted rows are mostly small differences
+    template <typename T> T heightAt(size_t r, size_t c) {
+        double h = 400.0 + 30.0 * std::sin(r * 0.05) + 20.0 * std::cos(c * 0.03) + 0.01 * double(r * c % 97);
+        if constexpr (std::is_floating_point_v<T>)
+            return T(h);
+        else
+            return T(h * 100.0);
+    }
+
+    template <typename T>
+    geotiv::RasterCollection makeSurface(size_t rows, size_t cols, geotiv::Compression compression,
+                                         geotiv::Predictor predictor) {
+        auto layer = makeLayer<T>(rows, cols, heightAt<T>, compression);
+        layer.predictor = predictor;
+        return collectionOf({std::move(layer)});
+    }
+
+    // Scalar reference of predictor 2 on little-endian words
+    template <typename U> std::vector<uint8_t> referenceDifference(std::vector<uint8_t> row, size_t stride) {
+        size_t n = row.size() / sizeof(U);
+        std::vector<U> v(n);
+        std::memcpy(v.data(), row.data(), row.size());
+        for (size_t i = n; i-- > stride;)
+            v[i] = U(v[i] - v[i - stride]);
+        std::memcpy(row.data(), v.data(), row.size());
+        return row;
+    }
+
+    template <typename U> void checkKernels() {
+        std::mt19937 rng(42);
+        for (size_t stride : {1u, 2u, 3u, 4u}) {
+            for (size_t n : {0u, 1u, 5u, 17u, 64u, 203u}) {
+                std::vector<uint8_t> row(n * sizeof(U));
+                for (auto &b : row)
+                    b = uint8_t(rng());
+                auto diffed = row;
+                geotiv::detail::differenceRow<true, U>(diffed.data(), n, stride);
+                CHECK(diffed == referenceDifference<U>(row, stride));
+                geotiv::detail::accumulateRow<true, U>(diffed.data(), n, stride);
+                CHECK(diffed == row);
+
+                // Non-native byte order takes the swapping path and must agree with itself
+                auto swapped = row;
+                geotiv::detail::differenceRow<false, U>(swapped.data(), n, stride);
+                geotiv::detail::accumulateRow<false, U>(swapped.data(), n, stride);
+                CHECK(swapped == row);
+            }
+        }
+    }
+
+    template <typename T> void checkRoundTrip(geotiv::Compression compression, geotiv::Predictor predictor) {
+        const size_t rows = 61, cols = 83;
+        auto rc = makeSurface<T>(rows, cols, compression, predictor);
+        for (uint32_t tileSize : {0u, 32u}) {
+            geotiv::WriteOptions opts;
+            opts.tileSize = tileSize;
+            opts.rowsPerStrip = 16;
+            opts.threads = 4;
+            std::string file = "predictor_roundtrip.tif";
+            geotiv::WriteRasterCollection(rc, file, opts);
+
+            geotiv::ReadOptions readOpts{geotiv::ReadBackend::Pread};
+            readOpts.threads = 4;
+            auto back = geotiv::ReadRasterCollection(file, readOpts);
+            CHECK(back.layers[0].predictor == predictor);
+            CHECK(matches(back.layers[0].gridAs<T>(), 0, 0, heightAt<T>));
+
+            auto win = geotiv::ReadWindow(file, 0, 7, 11, 30, 40);
+            CHECK(matches(win.gridAs<T>(), 7, 11, heightAt<T>));
+
+            geotiv::ReadOptions lazyOpts;
+            lazyOpts.lazy = true;
+            CHECK(geotiv::toTiffBytes(geotiv::ReadRasterCollection(file, lazyOpts), opts) ==
+                  geotiv::toTiffBytes(rc, opts));
+            std::filesystem::remove(file);
+        }
+    }
+} // namespace
+
+TEST_CASE("Predictors") {
+    SUBCASE("Row kernels match the scalar definition for every word size and stride") {
+        checkKernels<uint8_t>();
+        checkKernels<uint16_t>();
+        checkKernels<uint32_t>();
+        checkKernels<uint64_t>();
+    }
+
+    SUBCASE("Reference rows") {
+        std::vector<uint8_t> row = {10, 12, 15, 15, 9};
+        geotiv::detail::applyPredictor<true>(geotiv::Predictor::Horizontal, row.data(), 1, 5, 1, 1);
+        CHECK(row == std::vector<uint8_t>{10, 2, 3, 0, 250});
+
+        // Big-endian 16-bit words: 0x0102, 0x0105 -> 0x0102, 0x0003
+        std::vector<uint8_t> be = {0x01, 0x02, 0x00, 0x03};
+        geotiv::detail::undoPredictor<false>(geotiv::Predictor::Horizontal, be.data(), 1, 2, 1, 2);
+        CHECK(be == std::vector<uint8_t>{0x01, 0x02, 0x01, 0x05});
+
+        // Two 1.0f samples: byte planes 3F 3F | 80 80 | 00 00 | 00 00, then byte differences
+        std::vector<uint8_t> fp = {0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0x3F};
+        geotiv::detail::applyPredictor<true>(geotiv::Predictor::FloatingPoint, fp.data(), 1, 2, 1, 4);
+        CHECK(fp == std::vector<uint8_t>{0x3F, 0x00, 0x41, 0x00, 0x80, 0x00, 0x00, 0x00});
+        geotiv::detail::undoPredictor<true>(geotiv::Predictor::FloatingPoint, fp.data(), 1, 2, 1, 4);
+        CHECK(fp == std::vector<uint8_t>{0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0x3F});
+    }
+
+    SUBCASE("Predicted layers round trip through strips, tiles, windows and lazy reads") {
+        checkRoundTrip<uint8_t>(geotiv::Compression::LZW, geotiv::Predictor::Horizontal);
+        checkRoundTrip<uint16_t>(geotiv::Compression::LZW, geotiv::Predictor::Horizontal);
+        checkRoundTrip<int32_t>(geotiv::Compression::LZW, geotiv::Predictor::Horizontal);
+        checkRoundTrip<float>(geotiv::Compression::LZW, geotiv::Predictor::FloatingPoint);
+        checkRoundTrip<double>(geotiv::Compression::LZW, geotiv::Predictor::FloatingPoint);
+        checkRoundTrip<float>(geotiv::Compression::LZW, geotiv::Predictor::Horizontal);
+        if (geotiv::compressionAvailable(geotiv::Compression::Deflate)) {
+            checkRoundTrip<uint16_t>(geotiv::Compression::Deflate, geotiv::Predictor::Horizontal);
+            checkRoundTrip<float>(geotiv::Compression::Deflate, geotiv::Predictor::FloatingPoint);
+        }
+    }
+
+    SUBCASE("Predictors shrink smooth surfaces") {
+        auto plain = geotiv::toTiffBytes(
+            makeSurface<uint16_t>(128, 128, geotiv::Compression::LZW, geotiv::Predictor::None));
+        auto predicted = geotiv::toTiffBytes(
+            makeSurface<uint16_t>(128, 128, geotiv::Compression::LZW, geotiv::Predictor::Horizontal));
+        CHECK(predicted.size() < plain.size());
+
+        auto plainFloat =
+            geotiv::toTiffBytes(makeSurface<float>(128, 128, geotiv::Compression::LZW, geotiv::Predictor::None));
+        auto predictedFloat = geotiv::toTiffBytes(
+            makeSurface<float>(128, 128, geotiv::Compression::LZW, geotiv::Predictor::FloatingPoint));
+        CHECK(predictedFloat.size() < plainFloat.size());
+    }
+
+    SUBCASE("Predictors need LZW or Deflate, and float samples for the floating-point one") {
+        CHECK_THROWS_AS(
+            geotiv::toTiffBytes(makeSurface<uint16_t>(8, 8, geotiv::Compression::None, geotiv::Predictor::Horizontal)),
+            std::runtime_error);
+        CHECK_THROWS_AS(geotiv::toTiffBytes(
+                            makeSurface<uint16_t>(8, 8, geotiv::Compression::PackBits, geotiv::Predictor::Horizontal)),
+                        std::runtime_error);
+        CHECK_THROWS_AS(geotiv::toTiffBytes(
+                            makeSurface<uint16_t>(8, 8, geotiv::Compression::LZW, geotiv::Predictor::FloatingPoint)),
+                        std::runtime_error);
+    }
+}
@@ -4,6 +4,7 @@
 #include "geotiv/raster.hpp"
 #include <filesystem>
 #include <algorithm>
+#include <utility>
 
 TEST_CASE("Raster - Basic Construction") {
     concord::Datum datum{52.0, 5.0, 0.0};
@@ -230,6 +231,59 @@ TEST_CASE("Raster - File I/O") {
         // Cleanup
         std::filesystem::remove(testFile);
     }
+
+    SUBCASE("Lazy load decodes grids on first access") {
+        originalRaster.toFile(testFile);
+
+        geotiv::ReadOptions opts;
+        opts.lazy = true;
+        auto lazyRaster = geotiv::Raster::fromFile(testFile, opts);
+
+        CHECK(lazyRaster.gridCount() == 2);
+        CHECK_FALSE(lazyRaster.isLoaded());
+
+        // Const access never decodes: deferred layers come back as they are
+        const auto &constRaster = lazyRaster;
+        CHECK_FALSE(constRaster.getGrid(1).isMaterialized());
+        CHECK_FALSE(constRaster.getGrid(lazyRaster.getGridNames()[1]).isMaterialized());
+        CHECK(constRaster.filterByProperty("width", "20").size() == 2);
+        CHECK_THROWS_AS(constRaster.getGrid(1).gridAs<uint8_t>(), std::runtime_error);
+
+        const auto &grid1 = lazyRaster.getGrid(1);
+        CHECK(grid1.isMaterialized());
+        CHECK(grid1.grid.rows() == 20);
+        CHECK(grid1.grid(3, 4) == 12); // occlusion: r * c
+        CHECK(constRaster.getGrid(1).gridAs<uint8_t>()(3, 4) == 12);
+        CHECK_FALSE(lazyRaster.isLoaded());
+
+        // Writing back decodes the remaining layer from the still-open file into a temporary
+        std::filesystem::path copyFile = std::filesystem::temp_directory_path() / "test_raster_lazy_copy.tif";
+        constRaster.toFile(copyFile);
+        CHECK_FALSE(lazyRaster.isLoaded());
+        auto copy = geotiv::Raster::fromFile(copyFile);
+        CHECK(copy.getGrid(0).grid(5, 6) == 11); // terrain: r + c
+        CHECK(copy.getGrid(1).grid(3, 4) == 12);
+
+        // Iterating decodes only the layers the loop materializes
+        auto fresh = geotiv::Raster::fromFile(testFile, opts);
+        for (auto &layer : fresh) {
+            CHECK_FALSE(layer.isMaterialized());
+            if (layer.name == lazyRaster.getGridNames()[1])
+                CHECK(layer.materialize()(3, 4) == 12);
+        }
+        CHECK(fresh.getGridNames() == lazyRaster.getGridNames());
+        CHECK_FALSE(std::as_const(fresh).getGrid(0).isMaterialized());
+        CHECK(std::as_const(fresh).getGrid(1).isMaterialized());
+        for (const auto &layer : std::as_const(fresh))
+            CHECK(layer.properties.at("width") == "20");
+
+        fresh.load();
+        CHECK(fresh.isLoaded());
+        CHECK(std::as_const(fresh).getGrid(0).gridAs<uint8_t>()(5, 6) == 11);
+
+        std::filesystem::remove(copyFile);
+        std::filesystem::remove(testFile);
+    }
 }
 
 TEST_CASE("Raster - Error Handling") {
@@ -0,0 +1,166 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "geotiv/raster.hpp"
+#include "helpers.hpp"
+#include <cstring>
+#include <doctest/doctest.h>
+#include <filesystem>
+
+using namespace helpers;
+
+namespace {
+    // Distinct per-pixel value that exercises sign, magnitude and fractions where T allows them
+    template <typename T> T sampleAt(size_t r, size_t c) {
+        if constexpr (std::is_floating_point_v<T>)
+            return T(r * 1000.25 - c * 3.5);
+        else if constexpr (std::is_signed_v<T>)
+            return T(int64_t(r * 37) - int64_t(c * 11));
+        else
+            return T(r * 1031 + c * 7 + 60000);
+    }
+
+    template <typename T> geotiv::RasterCollection makeCollection(size_t rows, size_t cols) {
+        return collectionOf({makeLayer<T>(rows, cols, sampleAt<T>)});
+    }
+
+    template <typename T> void checkRoundTrip(geotiv::SampleType expected) {
+        const size_t rows = 37, cols = 50;
+        auto rc = makeCollection<T>(rows, cols);
+        CHECK(rc.layers[0].sampleType == expected);
+
+        for (uint32_t tileSize : {0u, 16u}) {
+            geotiv::WriteOptions opts;
+            opts.tileSize = tileSize;
+            opts.rowsPerStrip = 8;
+            std::string file = "sample_type_roundtrip.tif";
+            geotiv::WriteRasterCollection(rc, file, opts);
+
+            auto back = geotiv::ReadRasterCollection(file);
+            REQUIRE(back.layers.size() == 1);
+            CHECK(back.layers[0].sampleType == expected);
+            CHECK(back.layers[0].grid.rows() == (expected == geotiv::SampleType::UInt8 ? rows : 0));
+            CHECK(matches(back.layers[0].gridAs<T>(), 0, 0, sampleAt<T>));
+
+            geotiv::ReadOptions lazyOpts;
+            lazyOpts.lazy = true;
+            auto lazy = geotiv::ReadRasterCollection(file, lazyOpts);
+            CHECK_FALSE(lazy.layers[0].isMaterialized());
+            CHECK(matches(lazy.layers[0].gridAs<T>(), 0, 0, sampleAt<T>));
+
+            auto win = geotiv::ReadWindow(file, 0, 5, 9, 20, 30);
+            CHECK(win.sampleType == expected);
+            REQUIRE(win.gridAs<T>().rows() == 20);
+            CHECK(matches(win.gridAs<T>(), 5, 9, sampleAt<T>));
+
+            // A lazily read layer is decoded again while being written out
+            CHECK(geotiv::toTiffBytes(geotiv::ReadRasterCollection(file, lazyOpts), opts) ==
+                  geotiv::toTiffBytes(rc, opts));
+            std::filesystem::remove(file);
+        }
+    }
+} // namespace
+
+TEST_CASE("Sample types") {
+    SUBCASE("Every sample type round trips through strips, tiles, lazy and windowed reads") {
+        checkRoundTrip<uint8_t>(geotiv::SampleType::UInt8);
+        checkRoundTrip<int8_t>(geotiv::SampleType::Int8);
+        checkRoundTrip<uint16_t>(geotiv::SampleType::UInt16);
+        checkRoundTrip<int16_t>(geotiv::SampleType::Int16);
+        checkRoundTrip<uint32_t>(geotiv::SampleType::UInt32);
+        checkRoundTrip<int32_t>(geotiv::SampleType::Int32);
+        checkRoundTrip<float>(geotiv::SampleType::Float32);
+        checkRoundTrip<double>(geotiv::SampleType::Float64);
+    }
+
+    SUBCASE("BitsPerSample and SampleFormat are written") {
+        auto bytes = geotiv::toTiffBytes(makeCollection<float>(4, 4));
+        // 4x4 float32 pixels follow the 8-byte header, the IFD follows them
+        uint32_t ifd = bytes[4] | bytes[5] << 8 | bytes[6] << 16 | uint32_t(bytes[7]) << 24;
+        CHECK(ifd == 8 + 4 * 4 * 4);
+        uint16_t entries = bytes[ifd] | bytes[ifd + 1] << 8;
+        std::map<uint16_t, uint16_t> shorts;
+        for (uint16_t i = 0; i < entries; ++i) {
+            const uint8_t *e = bytes.data() + ifd + 2 + i * 12;
+            shorts[uint16_t(e[0] | e[1] << 8)] = uint16_t(e[8] | e[9] << 8);
+        }
+        CHECK(shorts[258] == 32);
+        CHECK(shorts[339] == 3);
+        CHECK(geotiv::toTiffBytes(makeCollection<uint8_t>(4, 4)).size() < bytes.size());
+    }
+
+    SUBCASE("Big-endian float32 samples are swapped on read") {
+        // Classic MM file, one 3x2 float32 strip
+        std::vector<uint8_t> out = {'M', 'M', 0, 42, 0, 0, 0, 8};
+        auto put = [&](uint64_t v, int n) {
+            for (int i = n - 1; i >= 0; --i)
+                out.push_back(uint8_t(v >> (8 * i)));
+        };
+        for (int i = 0; i < 6; ++i) {
+            float f = -1.5f + i * 0.75f;
+            uint32_t bits;
+            std::memcpy(&bits, &f, 4);
+            put(bits, 4);
+        }
+        uint32_t ifd = uint32_t(out.size());
+        out[7] = uint8_t(ifd);
+        auto entry = [&](uint16_t tag, uint16_t type, uint32_t value) {
+            put(tag, 2);
+            put(type, 2);
+            put(1, 4);
+            if (type == 3) {
+                put(value, 2);
+                put(0, 2);
+            } else {
+                put(value, 4);
+            }
+        };
+        put(8, 2);
+        entry(256, 3, 3);
+        entry(257, 3, 2);
+        entry(258, 3, 32);
+        entry(259, 3, 1);
+        entry(262, 3, 1);
+        entry(273, 4, 8);
+        entry(279, 4, 24);
+        entry(339, 3, 3);
+        put(0, 4);
+
+        std::string file = "sample_type_mm.tif";
+        writeBytes(file, out);
+        auto rc = geotiv::ReadRasterCollection(file);
+        REQUIRE(rc.layers[0].sampleType == geotiv::SampleType::Float32);
+        const auto &g = rc.layers[0].gridAs<float>();
+        CHECK(g(0, 0) == -1.5f);
+        CHECK(g(1, 2) == 2.25f);
+        std::filesystem::remove(file);
+    }
+
+    SUBCASE("Unsupported sample layouts and mismatched access throw") {
+        CHECK(geotiv::sampleTypeFromTiff(16, 2) == geotiv::SampleType::Int16);
+        CHECK_THROWS_AS(geotiv::sampleTypeFromTiff(12, 1), std::runtime_error);
+        CHECK_THROWS_AS(geotiv::sampleTypeFromTiff(16, 3), std::runtime_error);
+
+        auto rc = makeCollection<uint16_t>(4, 4);
+        CHECK_THROWS_AS(rc.layers[0].gridAs<float>(), std::runtime_error);
+
+        rc.layers[0].sampleType = geotiv::SampleType::Float32; // samples still hold uint16
+        CHECK_THROWS_AS(geotiv::toTiffBytes(rc), std::runtime_error);
+    }
+
+    SUBCASE("Raster keeps typed grids through a file") {
+        geotiv::Raster raster(datum, shift, 0.5);
+        raster.addGrid<float>(12, 9, "elevation", "elevation");
+        raster.addGrid(12, 9, "mask", "mask");
+        raster.getGrid("elevation").gridAs<float>()(3, 4) = 412.125f;
+        raster.getGrid("mask").grid(3, 4) = 7;
+
+        std::string file = "sample_type_raster.tif";
+        raster.toFile(file);
+        auto back = geotiv::Raster::fromFile(file);
+        REQUIRE(back.gridCount() == 2);
+        CHECK(back.getGrid(0).sampleType == geotiv::SampleType::Float32);
+        CHECK(back.getGrid(0).gridAs<float>()(3, 4) == 412.125f);
+        CHECK(back.getGrid(1).grid(3, 4) == 7);
+        std::filesystem::remove(file);
+    }
+}
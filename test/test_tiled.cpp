@@ -0,0 +1,220 @@
+#include "concord/concord.hpp"
+#include "geotiv/geotiv.hpp"
+#include "helpers.hpp"
+#include <doctest/doctest.h>
+#include <filesystem>
+
+using namespace helpers;
+
+namespace {
+    // Minimal tiled TIFF as produced by GDAL: no geotags, SHORT dimensions, LONG tile arrays.
+    // Pixel (r, c) holds (r * 16 + c) & 0xFF; edge tiles are padded with 0xEE.
+    std::vector<uint8_t> makeTiledTiff(uint32_t W, uint32_t H, uint32_t tw, uint32_t th, bool bigEndian) {
+        std::vector<uint8_t> out;
+        auto put16 = [&](uint16_t v) {
+            if (bigEndian) {
+                out.push_back(uint8_t(v >> 8));
+                out.push_back(uint8_t(v));
+            } else {
+                out.push_back(uint8_t(v));
+                out.push_back(uint8_t(v >> 8));
+            }
+        };
+        auto put32 = [&](uint32_t v) {
+            if (bigEndian) {
+                put16(uint16_t(v >> 16));
+                put16(uint16_t(v));
+            } else {
+                put16(uint16_t(v));
+                put16(uint16_t(v >> 16));
+            }
+        };
+
+        uint32_t across = (W + tw - 1) / tw, down = (H + th - 1) / th, n = across * down;
+        out.push_back(bigEndian ? 'M' : 'I');
+        out.push_back(bigEndian ? 'M' : 'I');
+        put16(42);
+        put32(0); // patched below
+
+        std::vector<uint32_t> offsets, counts;
+        for (uint32_t ty = 0; ty < down; ++ty) {
+            for (uint32_t tx = 0; tx < across; ++tx) {
+                offsets.push_back(uint32_t(out.size()));
+                counts.push_back(tw * th);
+                for (uint32_t r = ty * th; r < (ty + 1) * th; ++r) {
+                    for (uint32_t c = tx * tw; c < (tx + 1) * tw; ++c) {
+                        out.push_back(r < H && c < W ? uint8_t((r * 16 + c) & 0xFF) : 0xEE);
+                    }
+                }
+            }
+        }
+
+        uint32_t ifd = uint32_t(out.size());
+        uint32_t arrays = ifd + 2 + 9 * 12 + 4;
+        if (bigEndian) {
+            out[4] = uint8_t(ifd >> 24), out[5] = uint8_t(ifd >> 16), out[6] = uint8_t(ifd >> 8), out[7] = uint8_t(ifd);
+        } else {
+            out[4] = uint8_t(ifd), out[5] = uint8_t(ifd >> 8), out[6] = uint8_t(ifd >> 16), out[7] = uint8_t(ifd >> 24);
+        }
+        auto shortEntry = [&](uint16_t tag, uint16_t v) {
+            put16(tag);
+            put16(3);
+            put32(1);
+            put16(v);
+            put16(0);
+        };
+        put16(9);
+        shortEntry(256, uint16_t(W));
+        shortEntry(257, uint16_t(H));
+        shortEntry(258, 8);
+        shortEntry(259, 1);
+        shortEntry(262, 1);
+        shortEntry(322, uint16_t(tw));
+        shortEntry(323, uint16_t(th));
+        put16(324);
+        put16(4);
+        put32(n);
+        put32(n == 1 ? offsets[0] : arrays);
+        put16(325);
+        put16(4);
+        put32(n);
+        put32(n == 1 ? counts[0] : arrays + 4 * n);
+        put32(0);
+        if (n > 1) {
+            for (auto o : offsets)
+                put32(o);
+            for (auto c : counts)
+                put32(c);
+        }
+        return out;
+    }
+
+    // Collection of 8-bit layers, layer li holding (li * 31 + r * 7 + c) & 0xFF and a custom tag 50010
+    geotiv::RasterCollection makeCollection(size_t rows, size_t cols, int layers) {
+        std::vector<geotiv::Layer> all;
+        for (int li = 0; li < layers; ++li) {
+            auto layer =
+                makeLayer<uint8_t>(rows, cols, [li](size_t r, size_t c) { return (li * 31 + r * 7 + c) & 0xFF; });
+            layer.customTags[50010] = {static_cast<uint32_t>(li), 1u, 2u};
+            all.push_back(std::move(layer));
+        }
+        return collectionOf(std::move(all));
+    }
+} // namespace
+
+TEST_CASE("Tiled GeoTIFF reading") {
+    SUBCASE("Tiles with partial edge tiles decode in both byte orders") {
+        for (bool bigEndian : {false, true}) {
+            std::string testFile = bigEndian ? "tiled_mm.tif" : "tiled_ii.tif";
+            writeBytes(testFile, makeTiledTiff(37, 21, 16, 16, bigEndian));
+
+            geotiv::RasterCollection rc;
+            REQUIRE_NOTHROW(rc = geotiv::ReadRasterCollection(testFile));
+            REQUIRE(rc.layers.size() == 1);
+            const auto &L = rc.layers[0];
+            CHECK(L.isTiled());
+            CHECK(L.tileWidth == 16);
+            CHECK(L.tileLength == 16);
+            CHECK(L.tileOffsets.size() == 6);
+            CHECK(L.stripOffsets.empty());
+            REQUIRE(L.grid.rows() == 21);
+            REQUIRE(L.grid.cols() == 37);
+
+            CHECK(matches(L.grid, 0, 0, [](size_t r, size_t c) { return (r * 16 + c) & 0xFF; }));
+
+            std::filesystem::remove(testFile);
+        }
+    }
+
+    SUBCASE("Single tile covering the whole image") {
+        std::string testFile = "tiled_single.tif";
+        writeBytes(testFile, makeTiledTiff(10, 5, 16, 16, false));
+        auto rc = geotiv::ReadRasterCollection(testFile);
+        CHECK(rc.layers[0].grid(4, 9) == uint8_t(4 * 16 + 9));
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Windows read only the intersecting tiles") {
+        std::string testFile = "tiled_window.tif";
+        writeBytes(testFile, makeTiledTiff(70, 50, 16, 16, false));
+
+        // Window straddling four tiles, including the right/bottom edge tiles
+        auto win = geotiv::ReadWindow(testFile, 0, 40, 60, 10, 10);
+        REQUIRE(win.grid.rows() == 10);
+        CHECK(matches(win.grid, 40, 60, [](size_t r, size_t c) { return (r * 16 + c) & 0xFF; }));
+        CHECK_FALSE(win.isTiled());
+
+        geotiv::ReadOptions opts;
+        opts.lazy = true;
+        auto lazy = geotiv::ReadRasterCollection(testFile, opts);
+        CHECK(lazy.layers[0].materialize()(49, 69) == uint8_t((49 * 16 + 69) & 0xFF));
+
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Missing tile offsets are rejected") {
+        auto bytes = makeTiledTiff(20, 20, 16, 16, false);
+        std::string testFile = "tiled_bad.tif";
+
+        // Shrink TileWidth/TileLength to 8: nine tiles are now required but only four are listed
+        size_t ifd = bytes[4] | (bytes[5] << 8) | (bytes[6] << 16) | (bytes[7] << 24);
+        for (size_t e = ifd + 2; e < ifd + 2 + 9 * 12; e += 12) {
+            uint16_t tag = uint16_t(bytes[e] | (bytes[e + 1] << 8));
+            if (tag == 322 || tag == 323)
+                bytes[e + 8] = 8;
+        }
+        writeBytes(testFile, bytes);
+        CHECK_THROWS(geotiv::ReadRasterCollection(testFile));
+        std::filesystem::remove(testFile);
+    }
+}
+
+TEST_CASE("Tiled GeoTIFF writing") {
+    SUBCASE("Tiled round trip with partial edge tiles") {
+        auto rc = makeCollection(45, 70, 2);
+        for (uint32_t tileSize : {16u, 32u, 256u}) {
+            geotiv::WriteOptions opts;
+            opts.tileSize = tileSize;
+            std::string testFile = "tiled_write.tif";
+            REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile, opts));
+
+            auto back = geotiv::ReadRasterCollection(testFile);
+            REQUIRE(back.layers.size() == 2);
+            for (size_t li = 0; li < 2; ++li) {
+                const auto &L = back.layers[li];
+                CHECK(L.isTiled());
+                CHECK(L.tileWidth == tileSize);
+                CHECK(L.tileLength == tileSize);
+                CHECK(L.tileOffsets.size() == ((70 + tileSize - 1) / tileSize) * ((45 + tileSize - 1) / tileSize));
+                CHECK(L.customTags.at(50010) == std::vector<uint32_t>{static_cast<uint32_t>(li), 1u, 2u});
+                CHECK(L.datum.lat == doctest::Approx(datum.lat).epsilon(0.001));
+                CHECK(L.shift.angle.yaw == doctest::Approx(shift.angle.yaw).epsilon(0.001));
+                CHECK(sameGrid(L.grid, rc.layers[li].grid));
+            }
+
+            auto win = geotiv::ReadWindow(testFile, 1, 30, 50, 15, 20);
+            CHECK(win.grid(14, 19) == rc.layers[1].grid(44, 69));
+
+            std::filesystem::remove(testFile);
+        }
+    }
+
+    SUBCASE("Strip layout stays the default") {
+        auto rc = makeCollection(8, 8, 1);
+        rc.layers[0].imageDescription = "ab"; // short enough to be stored inline in the IFD entry
+        std::string testFile = "strip_default.tif";
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile));
+        auto back = geotiv::ReadRasterMetadata(testFile);
+        CHECK_FALSE(back.layers[0].isTiled());
+        CHECK(back.layers[0].stripOffsets.size() == 1);
+        CHECK(back.layers[0].imageDescription == "ab");
+        std::filesystem::remove(testFile);
+    }
+
+    SUBCASE("Tile size must be a multiple of 16") {
+        auto rc = makeCollection(8, 8, 1);
+        geotiv::WriteOptions opts;
+        opts.tileSize = 24;
+        CHECK_THROWS(geotiv::toTiffBytes(rc, opts));
+    }
+}
@@ -3,6 +3,7 @@
 #include <doctest/doctest.h>
 #include <filesystem>
 #include <fstream>
+#include <tuple>
 
 TEST_CASE("GeoTIFF Writer functionality") {
     SUBCASE("Create simple raster collection and convert to bytes") {
@@ -159,4 +160,113 @@ TEST_CASE("GeoTIFF Writer functionality") {
         // Clean up
         std::filesystem::remove(testFile);
     }
+
+    SUBCASE("Streamed file matches toTiffBytes") {
+        // 1100 x 1000 layers span several write chunks
+        size_t rows = 1000, cols = 1100;
+        concord::Datum datum{45.0, 9.0, 100.0};
+        concord::Pose shift{concord::Point{5, 5, 0}, concord::Euler{0, 0, 0}};
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 1.0;
+        for (int layerIdx = 0; layerIdx < 2; ++layerIdx) {
+            concord::Grid<uint8_t> grid(rows, cols, 1.0, true, shift);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    grid(r, c) = static_cast<uint8_t>(r * 3 + c + layerIdx);
+                }
+            }
+            geotiv::Layer layer;
+            layer.grid = std::move(grid);
+            layer.width = static_cast<uint32_t>(cols);
+            layer.height = static_cast<uint32_t>(rows);
+            layer.samplesPerPixel = 1;
+            layer.planarConfig = 1;
+            layer.datum = datum;
+            layer.shift = shift;
+            layer.resolution = 1.0;
+            rc.layers.push_back(std::move(layer));
+        }
+
+        auto readFile = [](const std::string &path) {
+            std::ifstream ifs(path, std::ios::binary);
+            return std::vector<uint8_t>(std::istreambuf_iterator<char>(ifs), {});
+        };
+
+        std::string testFile = "test_streamed.tif";
+        for (uint32_t tileSize : {0u, 256u}) {
+            geotiv::WriteOptions opts;
+            opts.tileSize = tileSize;
+            REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile, opts));
+            CHECK(readFile(testFile) == geotiv::toTiffBytes(rc, opts));
+        }
+
+        // Lazily read layers are decoded one at a time while streaming into a new file
+        geotiv::ReadOptions lazyOpts;
+        lazyOpts.lazy = true;
+        auto lazy = geotiv::ReadRasterCollection(testFile, lazyOpts);
+        std::string copyFile = "test_streamed_copy.tif";
+        REQUIRE_NOTHROW(geotiv::WriteRasterCollection(lazy, copyFile));
+        CHECK_FALSE(lazy.layers[0].isMaterialized());
+        auto back = geotiv::ReadRasterCollection(copyFile);
+        CHECK(back.layers[1].grid(999, 1099) == rc.layers[1].grid(999, 1099));
+        CHECK(back.layers[0].grid(500, 7) == rc.layers[0].grid(500, 7));
+
+        std::filesystem::remove(testFile);
+        std::filesystem::remove(copyFile);
+    }
+
+    SUBCASE("Multi-strip output by rows or by target bytes") {
+        size_t rows = 45, cols = 300;
+        concord::Datum datum{45.0, 9.0, 100.0};
+        concord::Pose shift{concord::Point{0, 0, 0}, concord::Euler{0, 0, 0}};
+        concord::Grid<uint8_t> grid(rows, cols, 1.0, true, shift);
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < cols; ++c) {
+                grid(r, c) = static_cast<uint8_t>(r * 5 + c);
+            }
+        }
+
+        geotiv::RasterCollection rc;
+        rc.datum = datum;
+        rc.shift = shift;
+        rc.resolution = 1.0;
+        geotiv::Layer layer;
+        layer.grid = grid;
+        layer.width = static_cast<uint32_t>(cols);
+        layer.height = static_cast<uint32_t>(rows);
+        layer.samplesPerPixel = 1;
+        layer.planarConfig = 1;
+        layer.datum = datum;
+        layer.shift = shift;
+        layer.resolution = 1.0;
+        rc.layers.push_back(std::move(layer));
+
+        std::string testFile = "test_strips.tif";
+        geotiv::WriteOptions byRows;
+        byRows.rowsPerStrip = 7;
+        geotiv::WriteOptions byBytes;
+        byBytes.stripBytes = 4096; // 13 rows of 300 bytes
+        for (auto [opts, rps, strips] : {std::tuple{byRows, 7u, 7u}, std::tuple{byBytes, 13u, 4u}}) {
+            REQUIRE_NOTHROW(geotiv::WriteRasterCollection(rc, testFile, opts));
+            auto back = geotiv::ReadRasterCollection(testFile);
+            const auto &L = back.layers[0];
+            CHECK(L.rowsPerStrip == rps);
+            REQUIRE(L.stripOffsets.size() == strips);
+            CHECK(L.stripByteCounts.back() == (rows - (strips - 1) * rps) * cols);
+            bool same = true;
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    same = same && L.grid(r, c) == grid(r, c);
+                }
+            }
+            CHECK(same);
+
+            auto win = geotiv::ReadWindow(testFile, 0, 20, 100, 10, 50);
+            CHECK(win.grid(9, 49) == grid(29, 149));
+        }
+        std::filesystem::remove(testFile);
+    }
 }